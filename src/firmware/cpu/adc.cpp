@@ -12,16 +12,6 @@ using namespace adk;
 
 Adc adc;
 
-void
-OnAdcResult(u8 channel, u16 result)
-{
-    if (channel == Light::AdcChannel::SENSOR_A ||
-        channel == Light::AdcChannel::SENSOR_B) {
-
-        light.OnAdcResult(channel, result);
-    }
-}
-
 Adc::Adc()
 {
     /* Internal Vcc reference. */
@@ -29,18 +19,46 @@ Adc::Adc()
     ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADPS0) | _BV(ADPS1) | _BV(ADPS2);
     inProgress = false;
     curChannel = 0;
+    scanActive = false;
+    scanDiscard = false;
+    discardSample = false;
+}
+
+bool
+Adc::SetMux(u8 channel)
+{
+    u8 admux = channel == TEMPERATURE_CHANNEL ?
+        _BV(REFS1) | _BV(REFS0) | channel : _BV(REFS0) | channel;
+    bool refChanged = ((ADMUX ^ admux) & (_BV(REFS1) | _BV(REFS0))) != 0;
+    ADMUX = admux;
+    return refChanged;
 }
 
 void
 Adc::Poll()
 {
     AtomicSection as;
-    if (pendingChannelsMask && !inProgress) {
+    /* Scan handler starts scheduled conversions between ticks. */
+    if (pendingChannelsMask && !inProgress && !scanActive) {
         inProgress = true;
         NextConversion();
     }
 }
 
+void
+Adc::SetOversampling(u8 channel, u8 bits)
+{
+    if (channel >= NUM_CHANNELS) {
+        return;
+    }
+    if (bits > MAX_OVERSAMPLING_BITS) {
+        bits = MAX_OVERSAMPLING_BITS;
+    }
+    AtomicSection as;
+    oversampling &= ~(static_cast<u32>(3) << (channel * 2));
+    oversampling |= static_cast<u32>(bits) << (channel * 2);
+}
+
 void
 Adc::ScheduleConversion(u8 channel)
 {
@@ -49,7 +67,7 @@ Adc::ScheduleConversion(u8 channel)
     }
     AtomicSection as;
     pendingChannelsMask |= 1 << channel;
-    if (!inProgress) {
+    if (!inProgress && !scanActive) {
         inProgress = true;
         NextConversion();
     }
@@ -65,7 +83,21 @@ Adc::SleepEnabled()
 void
 Adc::StartConversion(u8 channel)
 {
-    ADMUX = (ADMUX & ~0xf) | channel;
+    /* Reference voltage settles during the first conversion. */
+    discardSample = SetMux(channel);
+    StartHandler handler = reinterpret_cast<StartHandler>(
+        pgm_read_word(&adcStartHandlers[channel]));
+    if (handler && handler(channel)) {
+        discardSample = true;
+    }
+    accumulator = 0;
+    samplesLeft = 1 << (GetOversampling(channel) * 2);
+    StartSample();
+}
+
+void
+Adc::StartSample()
+{
     AVR_BIT_SET8(ADCSRA, ADSC);
 }
 
@@ -75,6 +107,9 @@ Adc::NextConversion()
     if (!pendingChannelsMask) {
         inProgress = false;
         curChannel = 0;
+        if (scanActive) {
+            scanDiscard = SetMux(scanList[scanIdx]);
+        }
         return;
     }
     u8 channel = curChannel + 1;
@@ -96,10 +131,140 @@ Adc::NextConversion()
 void
 Adc::HandleInterrupt()
 {
-    OnAdcResult(curChannel, (u16)ADCL | ((u16)ADCH << 8));
+    u16 value = (u16)ADCL | ((u16)ADCH << 8);
+    if (!inProgress) {
+        if (scanActive) {
+            HandleScanResult(value);
+        }
+        return;
+    }
+    if (discardSample) {
+        discardSample = false;
+        StartSample();
+        return;
+    }
+    accumulator += value;
+    samplesLeft--;
+    if (samplesLeft) {
+        StartSample();
+        return;
+    }
+    ProcessResult(curChannel, accumulator >> GetOversampling(curChannel));
     NextConversion();
 }
 
+void
+Adc::ProcessResult(u8 channel, u16 value)
+{
+    samples[channel].value = value;
+    samples[channel].timestamp = clock.GetTicks();
+    sampleSeq = sampleSeq + 1;
+
+    ResultHandler handler = reinterpret_cast<ResultHandler>(
+        pgm_read_word(&adcHandlers[channel]));
+    if (handler) {
+        handler(channel, value);
+    }
+}
+
+void
+Adc::HandleScanResult(u16 value)
+{
+    if (scanDiscard) {
+        /* Reference settled during this conversion, the same channel is
+         * converted again on the next tick.
+         */
+        scanDiscard = false;
+    } else {
+        u8 channel = scanList[scanIdx];
+        ProcessResult(channel, value);
+
+        u8 nextHead = (scanHead + 1) & (SCAN_BUF_SIZE - 1);
+        if (nextHead == scanTail) {
+            /* Drop the oldest entry. */
+            scanTail = (scanTail + 1) & (SCAN_BUF_SIZE - 1);
+            if (scanOverruns < 0xff) {
+                scanOverruns++;
+            }
+        }
+        scanBuf[scanHead].value = value;
+        scanBuf[scanHead].channel = channel;
+        scanHead = nextHead;
+
+        scanIdx++;
+        if (scanIdx >= scanCount) {
+            scanIdx = 0;
+        }
+    }
+    if (pendingChannelsMask) {
+        inProgress = true;
+        NextConversion();
+    } else {
+        scanDiscard = SetMux(scanList[scanIdx]);
+    }
+}
+
+void
+Adc::StartScan(const u8 *channels, u8 count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (count > MAX_SCAN_CHANNELS) {
+        count = MAX_SCAN_CHANNELS;
+    }
+    AtomicSection as;
+    for (u8 i = 0; i < count; i++) {
+        scanList[i] = channels[i];
+    }
+    scanCount = count;
+    scanIdx = 0;
+    scanHead = 0;
+    scanTail = 0;
+    scanActive = true;
+    scanDiscard = false;
+    if (!inProgress) {
+        scanDiscard = SetMux(scanList[0]);
+    }
+    /* Auto-trigger on timer 0 overflow. */
+    ADCSRB = _BV(ADTS2);
+    AVR_BIT_SET8(ADCSRA, ADATE);
+}
+
+void
+Adc::StopScan()
+{
+    AtomicSection as;
+    AVR_BIT_CLR8(ADCSRA, ADATE);
+    scanActive = false;
+}
+
+u8
+Adc::ReadScan(ScanEntry *buf, u8 size)
+{
+    AtomicSection as;
+    u8 n = 0;
+    while (n < size && scanTail != scanHead) {
+        buf[n++] = scanBuf[scanTail];
+        scanTail = (scanTail + 1) & (SCAN_BUF_SIZE - 1);
+    }
+    return n;
+}
+
+Adc::Sample
+Adc::GetSample(u8 channel)
+{
+    volatile Sample *src = &samples[channel];
+    Sample sample;
+    u8 seq;
+    do {
+        seq = sampleSeq;
+        sample.value = src->value;
+        sample.timestamp = src->timestamp;
+    } while (seq != sampleSeq);
+    return sample;
+}
+
 ISR(ADC_vect)
 {
     adc.HandleInterrupt();
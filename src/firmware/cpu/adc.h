@@ -9,14 +9,73 @@
 
 class Adc {
 public:
+    enum {
+        NUM_CHANNELS = 9,
+        /** Internal temperature sensor, converted with 1.1V internal
+         * reference.
+         */
+        TEMPERATURE_CHANNEL = 8,
+        /** Maximal number of additional result bits by oversampling. */
+        MAX_OVERSAMPLING_BITS = 3,
+        /** Maximal number of channels in scan list. */
+        MAX_SCAN_CHANNELS = 4,
+        /** Scan buffer size, power of two. */
+        SCAN_BUF_SIZE = 16
+    };
+
+    /** Conversion result handler. Called from interrupt.
+     *
+     * @param channel Converted channel.
+     * @param value Result value, resolution depends on oversampling.
+     */
+    typedef void (*ResultHandler)(u8 channel, u16 value);
+
+    /** Conversion start handler. Called from interrupt or with interrupts
+     * disabled right before the first conversion of the channel (e.g. to
+     * switch sensor excitation).
+     *
+     * @param channel Channel to convert.
+     * @return True if the input has been switched and the first conversion
+     *      should be discarded while it settles.
+     */
+    typedef bool (*StartHandler)(u8 channel);
+
+    /** Scan buffer entry. */
+    struct ScanEntry {
+        u16 value:10,
+            channel:4,
+            :2;
+    } __PACKED;
+
+    /** Latest conversion result of a channel. */
+    struct Sample {
+        u16 value;
+        /** Low part of system clock ticks when the result was ready. */
+        u16 timestamp;
+    };
+
     Adc();
 
     void
     Poll();
 
+    /** Schedule conversion of the channel. The result is stored as the
+     * channel latest sample and passed to the handler from adcHandlers table
+     * once all oversampled conversions are done.
+     */
     void
     ScheduleConversion(u8 channel);
 
+    /** Set oversampling for the channel. 4^bits back-to-back conversions are
+     * accumulated in the interrupt and decimated to (10 + bits)-bit result.
+     *
+     * @param channel Channel index.
+     * @param bits Number of additional result bits, up to
+     *      MAX_OVERSAMPLING_BITS.
+     */
+    void
+    SetOversampling(u8 channel, u8 bits);
+
     /** Prevent MCU from sleeping when ADC conversion in progress (since it will
      * probably stop I/O clock and will fail the conversion).
      */
@@ -24,30 +83,125 @@ public:
     SleepEnabled();
 
 
+    /** Get latest result of the channel. Safe to call without disabling
+     * interrupts.
+     */
+    Sample
+    GetSample(u8 channel);
+
+    /** Start scanning the channels list. One channel of the list is converted
+     * on each system clock tick, the conversion is auto-triggered by timer 0
+     * overflow so there is no software jitter. Results are stored in the scan
+     * buffer and as the latest channel sample, handlers are called as well.
+     * Oversampling is not applied to scanned samples.
+     * Scheduled conversions are interleaved between the ticks, a tick which
+     * falls on a scheduled conversion is skipped.
+     *
+     * @param channels Channels list.
+     * @param count Number of channels in the list, up to MAX_SCAN_CHANNELS.
+     *      Channels should use Vcc reference (temperature channel cannot be
+     *      scanned).
+     */
+    void
+    StartScan(const u8 *channels, u8 count);
+
+    void
+    StopScan();
+
+    /** Read accumulated scan results.
+     *
+     * @param buf Buffer for the entries.
+     * @param size Maximal number of entries to read.
+     * @return Number of entries read.
+     */
+    u8
+    ReadScan(ScanEntry *buf, u8 size);
+
+    /** Number of scan entries lost due to buffer overflow (saturated). */
+    u8
+    GetScanOverruns()
+    {
+        return scanOverruns;
+    }
+
     void
     HandleInterrupt();
 
 private:
-    enum {
-        NUM_CHANNELS = 9
-    };
     u16 pendingChannelsMask;
+    /** Oversampling bits, two bits per channel. */
+    u32 oversampling = 0;
+    /** Sum of the oversampled conversions. */
+    u16 accumulator;
+    /** Conversions left for the current channel. */
+    u8 samplesLeft;
+    /** Incremented after each sample update, readers retry if it changed. */
+    volatile u8 sampleSeq = 0;
+    Sample samples[NUM_CHANNELS];
+    u8 scanList[MAX_SCAN_CHANNELS];
+    ScanEntry scanBuf[SCAN_BUF_SIZE];
+    u8 scanOverruns = 0;
 
     u8 curChannel:4,
        inProgress:1,
-       reserved:3;
+       scanActive:1,
+    /** Reference has been switched for the scan, the next scan conversion
+     * is discarded.
+     */
+       scanDiscard:1,
+       :1;
+    u8 scanCount:3,
+    /** Index of the channel converted on the next tick. */
+       scanIdx:2,
+    /** Reference has been switched, the first conversion is discarded. */
+       discardSample:1,
+       :2;
+    /** Scan buffer write and read positions. */
+    u8 scanHead:4,
+       scanTail:4;
+
+    u8
+    GetOversampling(u8 channel)
+    {
+        return (oversampling >> (channel * 2)) & 3;
+    }
 
     void
     StartConversion(u8 channel);
 
+    /** Start single conversion of the current channel. */
+    void
+    StartSample();
+
     void
     NextConversion();
 
+    /** Select input channel and its reference for the next conversion.
+     *
+     * @return True if the reference has been switched.
+     */
+    bool
+    SetMux(u8 channel);
+
+    /** Store the result and call the channel handler. */
+    void
+    ProcessResult(u8 channel, u16 value);
+
+    /** Handle conversion triggered by scan. */
+    void
+    HandleScanResult(u16 value);
+
 } __PACKED;
 
-/** Called when conversion complete. Add needed calls to this function. */
-void
-OnAdcResult(u8 channel, u16 result);
+/** Result handlers indexed by channel, null for channels without handler.
+ * Defined by the application.
+ */
+extern const Adc::ResultHandler adcHandlers[Adc::NUM_CHANNELS] PROGMEM;
+
+/** Start handlers indexed by channel, null for channels without handler.
+ * Defined by the application.
+ */
+extern const Adc::StartHandler adcStartHandlers[Adc::NUM_CHANNELS] PROGMEM;
 
 extern Adc adc;
 
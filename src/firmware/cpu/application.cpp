@@ -20,6 +20,9 @@ Page::Poll()
     if (poll) {
         poll();
     }
+    if (drawList) {
+        drawList->Poll();
+    }
 }
 
 Application::Application()
@@ -31,6 +34,7 @@ void
 Application::Initialize()
 {
     sound.SetPattern(0xffff, false);
+    display.SetContentLostHandler(_OnDisplayReset);
     scheduler.ScheduleTask(_Tick, TICK_INTERVAL);
 }
 
@@ -54,6 +58,22 @@ Application::Poll()
         }
     }
     if (page) {
+        InputQueue::Event e;
+        while (inputQueue.Pop(e)) {
+            switch (e.type) {
+            case InputQueue::EventType::BUTTON_PRESSED:
+                OnButtonPressed();
+                break;
+            case InputQueue::EventType::BUTTON_LONG_PRESSED:
+                OnButtonLongPressed();
+                break;
+            case InputQueue::EventType::ROT_ENC:
+                OnRotEnc(e.delta, e.accelDelta);
+                break;
+            default:
+                break;
+            }
+        }
         page->Poll();
     }
 }
@@ -83,7 +103,7 @@ Application::OnButtonLongPressed()
 }
 
 void
-Application::OnRotEncClick(bool dir)
+Application::OnRotEnc(i8 delta, i16 accelDelta)
 {
     idleCounter = 0;
     if (display.IsSleeping()) {
@@ -93,7 +113,9 @@ Application::OnRotEncClick(bool dir)
 
     Page *page = CurPage();
     if (page) {
-        page->OnRotEncClick(dir);
+        if (delta) {
+            page->OnRotEnc(delta, accelDelta);
+        }
     }
 }
 
@@ -104,6 +126,16 @@ Application::SetPage(VariantFabric page)
     nextPage = nullptr;
 }
 
+void
+Application::_OnDisplayReset()
+{
+    display.Clear();
+    Page *page = app.CurPage();
+    if (page) {
+        page->OnDisplayReset();
+    }
+}
+
 u16
 Application::_Tick()
 {
@@ -17,6 +17,8 @@ public:
     typedef void (*PollHandler)();
 
     PollHandler poll = nullptr;
+    /** Draw sequence of the page if any. */
+    DrawList *drawList = nullptr;
 
     Page()
     {
@@ -35,12 +37,16 @@ public:
     OnButtonLongPressed()
     {}
 
-    /** Invoked when rotary encoder rotated on one click.
+    /** Invoked when rotary encoder rotated. Clicks accumulated since last
+     * invocation are batched.
      *
-     * @param dir CW direction when true, CCW when false.
+     * @param delta Number of clicks, positive for CW direction, negative for
+     *      CCW direction.
+     * @param accelDelta Number of clicks with velocity-based acceleration
+     *      applied. Use for large ranges values adjustment.
      */
     virtual void
-    OnRotEncClick(bool dir __UNUSED)
+    OnRotEnc(i8 delta __UNUSED, i16 accelDelta __UNUSED)
     {}
 
     /** Request page closing.
@@ -53,6 +59,17 @@ public:
     {
         return true;
     }
+
+    /** Display content was lost and the display was cleared, everything
+     * should be redrawn.
+     */
+    virtual void
+    OnDisplayReset()
+    {
+        if (drawList) {
+            drawList->Invalidate(0xffff);
+        }
+    }
 };
 
 /* Pages. */
@@ -70,22 +87,10 @@ public:
     void
     Initialize();
 
+    /** Also dispatches queued input events to the current page. */
     void
     Poll();
 
-    void
-    OnButtonPressed();
-
-    void
-    OnButtonLongPressed();
-
-    /** Invoked when rotary encoder rotated on one click.
-     *
-     * @param dir CW direction when true, CCW when false.
-     */
-    void
-    OnRotEncClick(bool dir);
-
     /** Set next page to display.
      *
      * @param pageTypeCode Code for the page type, obtained by GetPageTypeCode().
@@ -131,9 +136,21 @@ private:
     void
     SetPage(VariantFabric page);
 
+    void
+    OnButtonPressed();
+
+    void
+    OnButtonLongPressed();
+
+    void
+    OnRotEnc(i8 delta, i16 accelDelta);
+
     static u16
     _Tick();
 
+    static void
+    _OnDisplayReset();
+
     u16
     Tick();
 };
@@ -75,7 +75,7 @@ BitmapWriter::StartRequest()
         curBmpHeight = pgm_read_byte(&req.bmp->numPages);
         if (!req.clear) {
             curBmpData = reinterpret_cast<const u8 *>(pgm_read_word(&req.bmp->data));
-            curBmpData += reinterpret_cast<uintptr_t>(&bitmaps);
+            rleLeft = 0;
         }
     } else {
         curBmpWidth = req.bmp->numColumns;
@@ -95,10 +95,14 @@ BitmapWriter::StartRequest()
         curBmpCroppedHeight = curBmpHeight;
     }
 
-    display.Output(Display::Viewport {
-        req.col, static_cast<u8>(req.col + curBmpCroppedWidth - 1),
-        req.page, static_cast<u8>(req.page + curBmpCroppedHeight - 1)},
-        _OutputHandler);
+    if (!display.Output(Display::Viewport {
+            req.col, static_cast<u8>(req.col + curBmpCroppedWidth - 1),
+            req.page, static_cast<u8>(req.page + curBmpCroppedHeight - 1)},
+            _OutputHandler)) {
+
+        /* Display queue is full, retry from poll. */
+        reqInProgress = false;
+    }
 
     return true;
 }
@@ -110,7 +114,7 @@ BitmapWriter::NextRequest()
         reqQueue[curReq].handler();
     }
     reqQueue[curReq].bmp = 0;
-    if (curReq == SIZEOF_ARRAY(reqQueue)) {
+    if (curReq == SIZEOF_ARRAY(reqQueue) - 1) {
         curReq = 0;
     } else {
         curReq++;
@@ -118,6 +122,13 @@ BitmapWriter::NextRequest()
     reqInProgress = false;
 }
 
+void
+BitmapWriter::RequestDone()
+{
+    NextRequest();
+    StartRequest();
+}
+
 bool
 BitmapWriter::_OutputHandler(u8 column, u8 page, u8 *data)
 {
@@ -132,12 +143,7 @@ BitmapWriter::OutputHandler(u8 column, u8 page, u8 *data)
     if (req.clear) {
         _data = 0;
     } else {
-        if (req.isPgm) {
-            _data = pgm_read_byte(curBmpData);
-        } else {
-            _data = *curBmpData;
-        }
-        curBmpData++;
+        _data = NextByte(req.isPgm);
     }
 
     if (req.inversed) {
@@ -146,16 +152,70 @@ BitmapWriter::OutputHandler(u8 column, u8 page, u8 *data)
         *data = _data;
     }
 
-    if (curBmpWidth != curBmpCroppedWidth &&
+    if (curBmpWidth != curBmpCroppedWidth && !req.clear &&
         column == req.col + curBmpCroppedWidth -1) {
 
-        curBmpData += curBmpWidth - curBmpCroppedWidth;
+        SkipBytes(req.isPgm, curBmpWidth - curBmpCroppedWidth);
     }
 
     if (column == req.col + curBmpCroppedWidth - 1 &&
         page == req.page + curBmpCroppedHeight - 1) {
         /* Fully drawn. */
-        NextRequest();
+        RequestDone();
     }
     return true;
 }
+
+u8
+BitmapWriter::NextByte(bool isPgm)
+{
+    if (!isPgm) {
+        return *curBmpData++;
+    }
+    if (!rleLeft) {
+        u8 hdr = pgm_read_byte(curBmpData);
+        curBmpData++;
+        if (hdr < 0x80) {
+            rleLiteral = true;
+            rleLeft = hdr + 1;
+        } else {
+            rleLiteral = false;
+            if (hdr < 0xc0) {
+                rleLeft = (hdr & 0x3f) + 2;
+                rleByte = pgm_read_byte(curBmpData);
+                curBmpData++;
+            } else {
+                rleLeft = (hdr & 0x3f) + 1;
+                rleByte = 0;
+            }
+        }
+    }
+    rleLeft--;
+    if (rleLiteral) {
+        return pgm_read_byte(curBmpData++);
+    }
+    /* Run bytes do not touch program memory. */
+    return rleByte;
+}
+
+void
+BitmapWriter::SkipBytes(bool isPgm, u8 n)
+{
+    if (!isPgm) {
+        curBmpData += n;
+        return;
+    }
+    while (n) {
+        if (!rleLeft) {
+            NextByte(true);
+            n--;
+            continue;
+        }
+        u8 skip = n < rleLeft ? n : rleLeft;
+        rleLeft -= skip;
+        if (rleLiteral) {
+            curBmpData += skip;
+        }
+        n -= skip;
+    }
+}
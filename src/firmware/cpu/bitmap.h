@@ -13,8 +13,8 @@
 
 /** Bitmap descriptor. */
 struct Bitmap {
-    /** Pointer to data array if in data memory. Offset of data array relatively
-     * to Bitmaps class instance start address if in program memory.
+    /** Pointer to raw data array if in data memory. Pointer to compressed
+     * data if in program memory.
      */
     const u8 *data;
     /** Number of pages in the bitmap. */
@@ -23,7 +23,14 @@ struct Bitmap {
        numColumns;
 } __PACKED;
 
-/** Helper class for outputting bitmaps to the graphical display. */
+/** Helper class for outputting bitmaps to the graphical display.
+ *
+ * Bitmaps in program memory are compressed, the data is a sequence of tokens
+ * with the following header byte:
+ *  - 0x00-0x7f: literal, (h + 1) raw bytes follow.
+ *  - 0x80-0xbf: run, next byte repeated ((h & 0x3f) + 2) times.
+ *  - 0xc0-0xff: ((h & 0x3f) + 1) zero bytes.
+ */
 class BitmapWriter {
 public:
 
@@ -101,7 +108,13 @@ private:
        reserved3:1,
 
        curBmpCroppedHeight:3,
-       reserved4:5;
+    /** Current token is literal. */
+       rleLiteral:1,
+       reserved4:4;
+    /** Bytes left in the current token. */
+    u8 rleLeft,
+    /** Byte value of the current run token. */
+       rleByte;
     const u8 *curBmpData;
 
     void
@@ -118,6 +131,21 @@ private:
     void
     NextRequest();
 
+    /** Complete current request and start the next one. Called from the
+     * output handler after the last byte is provided so that the next output
+     * is queued to the display before the current one is finished.
+     */
+    void
+    RequestDone();
+
+    /** Get next byte of the current bitmap data. */
+    u8
+    NextByte(bool isPgm);
+
+    /** Skip the specified number of bytes in the current bitmap data. */
+    void
+    SkipBytes(bool isPgm, u8 n);
+
     static bool
     _OutputHandler(u8 column, u8 page, u8 *data);
 
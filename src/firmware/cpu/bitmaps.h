@@ -18,19 +18,162 @@ Bitmap_NumDataBytes()
     return sizeof...(data);
 }
 
-/** Define bitmap.
+/** Compile-time compression of bitmap data. See BitmapWriter for the encoded
+ * stream format description.
+ */
+namespace bitmap_rle {
+
+enum {
+    /** Minimal length of non-zero bytes run to encode it as a run. */
+    MIN_RUN = 3,
+    MAX_RUN = 65,
+    MAX_ZERO_RUN = 64,
+    MAX_LITERAL = 128
+};
+
+/** Raw bitmap data bytes. */
+template <u8... bytes>
+struct Data;
+
+template <>
+struct Data<> {
+    static constexpr u8
+    At(u16)
+    {
+        return 0;
+    }
+};
+
+template <u8 first, u8... rest>
+struct Data<first, rest...> {
+    static constexpr u16 SIZE = sizeof...(rest) + 1;
+
+    static constexpr u8
+    At(u16 idx)
+    {
+        return idx == 0 ? first : Data<rest...>::At(idx - 1);
+    }
+};
+
+/** Number of equal bytes starting at the specified position. */
+template <class TData>
+constexpr u8
+RunLength(u16 pos, u8 max, u8 len = 1)
+{
+    return pos + len < TData::SIZE && len < max &&
+        TData::At(pos + len) == TData::At(pos) ?
+        RunLength<TData>(pos, max, len + 1) : len;
+}
+
+template <class TData>
+constexpr bool
+IsZeroRun(u16 pos)
+{
+    return TData::At(pos) == 0;
+}
+
+template <class TData>
+constexpr bool
+IsRun(u16 pos)
+{
+    return IsZeroRun<TData>(pos) || RunLength<TData>(pos, MAX_RUN) >= MIN_RUN;
+}
+
+/** Number of literal bytes starting at the specified position. */
+template <class TData>
+constexpr u8
+LiteralLength(u16 pos, u8 len = 1)
+{
+    return pos + len < TData::SIZE && len < MAX_LITERAL &&
+        !IsRun<TData>(pos + len) ?
+        LiteralLength<TData>(pos, len + 1) : len;
+}
+
+/** Number of raw bytes encoded by the token at the specified position. */
+template <class TData>
+constexpr u8
+TokenInput(u16 pos)
+{
+    return IsZeroRun<TData>(pos) ? RunLength<TData>(pos, MAX_ZERO_RUN) :
+        IsRun<TData>(pos) ? RunLength<TData>(pos, MAX_RUN) :
+        LiteralLength<TData>(pos);
+}
+
+/** Encoded size of the token at the specified position. */
+template <class TData>
+constexpr u8
+TokenSize(u16 pos)
+{
+    return IsZeroRun<TData>(pos) ? 1 :
+        IsRun<TData>(pos) ? 2 :
+        1 + LiteralLength<TData>(pos);
+}
+
+template <class TData>
+constexpr u16
+EncodedSize(u16 pos = 0)
+{
+    return pos >= TData::SIZE ? 0 :
+        TokenSize<TData>(pos) + EncodedSize<TData>(pos + TokenInput<TData>(pos));
+}
+
+/** Get byte of the token at the specified position. */
+template <class TData>
+constexpr u8
+TokenByte(u16 pos, u8 idx)
+{
+    return IsZeroRun<TData>(pos) ?
+            0xc0 | (TokenInput<TData>(pos) - 1) :
+        IsRun<TData>(pos) ?
+            (idx == 0 ? 0x80 | (TokenInput<TData>(pos) - 2) : TData::At(pos)) :
+        (idx == 0 ? TokenInput<TData>(pos) - 1 : TData::At(pos + idx - 1));
+}
+
+/** Get byte of the encoded stream. */
+template <class TData>
+constexpr u8
+EncodedByte(u16 n, u16 pos = 0, u16 outPos = 0)
+{
+    return n >= outPos + TokenSize<TData>(pos) ?
+        EncodedByte<TData>(n, pos + TokenInput<TData>(pos),
+                           outPos + TokenSize<TData>(pos)) :
+        TokenByte<TData>(pos, n - outPos);
+}
+
+template <class TData, class TSeq>
+struct Encoded;
+
+template <class TData, u16... n>
+struct Encoded<TData, meta::IndexSeq<n...>> {
+    static const u8 data[sizeof...(n)];
+};
+
+template <class TData, u16... n>
+const u8 Encoded<TData, meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { EncodedByte<TData>(n)... };
+
+/** Compressed data for the specified raw bytes. Identical bitmaps share the
+ * same instance.
+ */
+template <u8... bytes>
+struct Bitmap {
+    using Type = Encoded<Data<bytes...>, typename meta::MakeIndexSeq<
+        EncodedSize<Data<bytes...>>()>::Type>;
+};
+
+} /* namespace bitmap_rle */
+
+/** Define bitmap. Data is stored compressed in program memory.
  * @param __name Name for accessing.
  * @param __numPages Number of pages in the bitmap. Number of columns defined as
  *      total number of data bytes divided by number of pages.
  * @param __VA_ARGS__ Data bytes.
  */
 #define DEF_BITMAP(__name, __numPages, ...) \
-    const u8 __CONCAT(__name, __data__) \
-        [Bitmap_NumDataBytes<__VA_ARGS__>()] = { __VA_ARGS__ }; \
     const Bitmap __name { \
-        reinterpret_cast<const u8 *>(OFFSETOF(Bitmaps, __CONCAT(__name, __data__))), \
+        bitmap_rle::Bitmap<__VA_ARGS__>::Type::data, \
         __numPages, \
-        sizeof(__CONCAT(__name, __data__)) / __numPages};
+        Bitmap_NumDataBytes<__VA_ARGS__>() / __numPages};
 
 /** Global bitmaps repository. Stored in program memory. */
 class Bitmaps {
@@ -37,6 +37,28 @@
 #define LVL_GAUGE_ECHO_PIN      0
 
 
+/** Port for RTC INT/SQW line. The line also outputs square wave while sound is
+ * active.
+ */
+#define RTC_INT_PORT            D
+/** Pin for RTC INT/SQW line. */
+#define RTC_INT_PIN             5
+/** Pin change interrupt bit for RTC INT/SQW line, should be in PCMSK2. */
+#define RTC_INT_PCINT           PCINT21
+
+
+/** Port for EC probe excitation line A. Probe is excited with alternating
+ * polarity by lines A and B to avoid electrodes polarization.
+ */
+#define EC_EXC_A_PORT           B
+/** Pin for EC probe excitation line A. */
+#define EC_EXC_A_PIN            1
+/** Port for EC probe excitation line B. */
+#define EC_EXC_B_PORT           B
+/** Pin for EC probe excitation line B. */
+#define EC_EXC_B_PIN            2
+
+
 /** Port for debugging LED. */
 #define LED_PORT                B
 /** Pin for debugging LED. */
@@ -129,21 +151,29 @@ extern Clock clock;
 
 #include "time.h"
 #include "variant.h"
+#include "meta.h"
 
 #include "strings.h"
 #include "led.h"
+#include "sys_monitor.h"
+#include "input.h"
 #include "i2c.h"
 #include "adc.h"
 #include "rtc.h"
+#include "wall_clock.h"
+#include "solar.h"
 #include "display.h"
 #include "text_writer.h"
 #include "bitmap.h"
 #include "bitmaps.h"
 #include "lighting.h"
+#include "temp_monitor.h"
+#include "nutrients.h"
 #include "pump.h"
 #include "level_gauge.h"
 #include "sound.h"
 #include "flooder.h"
+#include "draw_list.h"
 #include "application.h"
 
 #endif /* CPU_H_ */
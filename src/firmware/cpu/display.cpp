@@ -20,24 +20,85 @@ Display::Initialize()
     curVp.maxPage = 7;
     curColumn = curVp.minCol;
     curPage = curVp.minPage;
+    clockMode = I2cBus::ClockMode::CLOCK_DEFAULT;
+    probeDone = false;
+    vpLost = false;
+    transferFailures = 0;
+    contentLost = false;
+    i2cBus.RegisterDevice(DISPLAY_ADDRESS, _ResetHandler);
     state = State::INITIALIZING;
     HandleInitialization();
 }
 
+void
+Display::_ResetHandler()
+{
+    display.Reset();
+}
+
+void
+Display::Reset()
+{
+    AtomicSection as;
+    /* Controller state is unknown, initialization sequence deactivates
+     * scrolling and sets viewport.
+     */
+    cmdSize = 0;
+    cmdInProgress = false;
+    /* Stale requests failed by the bus recovery are not link errors. */
+    transferFailures = 0;
+    scrollActive = false;
+    scrollChanged = false;
+    vpLost = true;
+    /* Failed outputs were drained and scrolled region was shifted. */
+    contentLost = true;
+    initCounter = 0;
+    state = State::INITIALIZING;
+    scheduler.SchedulePoll();
+}
+
 void
 Display::SetSleep(bool f)
 {
     AtomicSection as;
-    if (f && !isSleeping) {
-        isSleeping = true;
-        SendCommand(Command::DISPLAY_OFF);
-    } else if (!f && isSleeping) {
-        isSleeping = false;
-        SendCommand(Command::DISPLAY_ON);
+    if (f != isSleeping) {
+        isSleeping = f;
+        sleepCmdPending = !sleepCmdPending;
+        scheduler.SchedulePoll();
+    }
+}
+
+void
+Display::SetScroll(u8 minPage, u8 maxPage, bool left, ScrollInterval interval,
+                   ScrollResetHandler resetHandler)
+{
+    AtomicSection as;
+    scrollResetHandler = resetHandler;
+    if (scrollEnabled && scrollMinPage == minPage && scrollMaxPage == maxPage &&
+        scrollLeft == left && scrollInterval == interval) {
+
+        return;
     }
+    /* Setup cannot be changed while scrolling, restart with new one. */
+    scrollChanged = scrollActive;
+    scrollMinPage = minPage;
+    scrollMaxPage = maxPage;
+    scrollLeft = left;
+    scrollInterval = interval;
+    scrollEnabled = true;
+    scheduler.SchedulePoll();
 }
 
 void
+Display::StopScroll()
+{
+    AtomicSection as;
+    scrollEnabled = false;
+    scrollResetHandler = nullptr;
+    scheduler.SchedulePoll();
+}
+
+bool
 Display::Output(Viewport vp, GraphicsProvider provider)
 {
     AtomicSection as;
@@ -54,12 +115,13 @@ Display::Output(Viewport vp, GraphicsProvider provider)
         }
         if (idx == curOutReq) {
             /* No free slot. */
-            return;
+            return false;
         }
     }
     outQueue[idx].vp = vp;
     outQueue[idx].provider = provider;
     scheduler.SchedulePoll();
+    return true;
 }
 
 void
@@ -68,11 +130,64 @@ Display::Poll()
     AtomicSection as;
     if (state == State::INITIALIZING) {
         HandleInitialization();
+    } else if (state == State::PROBING) {
+        HandleClockProbe();
+    } else if (state == State::FAILURE) {
+        if (static_cast<u8>(clock.GetTicks() - failureTicks) >=
+            INIT_RETRY_TICKS) {
+
+            Reset();
+        }
     } else if (state == State::READY) {
-        if (!outInProgress && outQueue[curOutReq].provider) {
-            outInProgress = true;
-            i2cBus.RequestTransfer(DISPLAY_ADDRESS, true, OutputTransferHandler);
+        if (contentLost) {
+            contentLost = false;
+            if (contentLostHandler) {
+                contentLostHandler();
+            }
+        }
+        HandleControl();
+        /* Scrolled region RAM is not accessible while scrolling. */
+        if (!outInProgress && outQueue[curOutReq].provider &&
+            !IsScrollBlocked(outQueue[curOutReq].vp)) {
+
+            RequestOutputTransfer();
+        }
+    }
+}
+
+void
+Display::HandleControl()
+{
+    if (cmdInProgress) {
+        return;
+    }
+    if (sleepCmdPending) {
+        sleepCmdPending = false;
+        SendCommand(isSleeping ? Command::DISPLAY_OFF : Command::DISPLAY_ON);
+        return;
+    }
+    bool scrollOutPending = IsScrollOutputPending();
+    /* Deactivate for the scrolled region output only after the current
+     * transfer is done, it may merge requests while the scrolling is active.
+     */
+    if (scrollActive && ((scrollOutPending && !outInProgress) ||
+                         !scrollEnabled || scrollChanged)) {
+        /* RAM content of the scrolled region should be rewritten after
+         * deactivation. Scroll setup change is followed by redraw anyway.
+         */
+        bool redraw = scrollEnabled && !scrollChanged;
+        scrollActive = false;
+        scrollChanged = false;
+        SendCommand(Command::DEACTIVATE_SCROLL);
+        if (redraw && scrollResetHandler) {
+            scrollResetHandler();
         }
+    } else if (!scrollActive && scrollEnabled && !scrollOutPending) {
+        scrollActive = true;
+        SendCommand(scrollLeft ? Command::LEFT_HORIZONTAL_SCROLL :
+                                 Command::RIGHT_HORIZONTAL_SCROLL,
+                    0, scrollMinPage, scrollInterval, scrollMaxPage, 0, 0xff,
+                    Command::ACTIVATE_SCROLL);
     }
 }
 
@@ -133,15 +248,74 @@ Display::HandleInitialization()
         SendCommand(Command::DISPLAY_ON);
         break;
     case 16:
-        SendCommand(Command::SET_COLUMN_ADDRESS, curVp.minCol, curVp.maxCol);
+        /* Scrolling may be left active if only MCU was reset. */
+        SendCommand(Command::DEACTIVATE_SCROLL);
         break;
     case 17:
+        SendCommand(Command::SET_COLUMN_ADDRESS, curVp.minCol, curVp.maxCol);
+        break;
+    case 18:
         SendCommand(Command::SET_PAGE_ADDRESS, curVp.minPage, curVp.maxPage);
         break;
     default:
-        state = State::READY;
+        /* Probe only once, keep the clock found on repeated
+         * initialization.
+         */
+        state = probeDone ? State::READY : State::PROBING;
+        initCounter = 0;
+        return;
+    }
+    initCounter++;
+}
+
+void
+Display::HandleClockProbe()
+{
+    if (cmdInProgress) {
+        return;
+    }
+    if (probeDone) {
+        /* Corrupted bytes could be taken as arbitrary commands so restart
+         * initialization. ACK does not prove that data is not corrupted so
+         * keep one step margin below the last clock which accepted NOPs.
+         */
+        LowerClock();
+        LowerClock();
+        initCounter = 0;
+        state = State::INITIALIZING;
+        return;
+    }
+    if (initCounter % PROBE_BURSTS == 0) {
+        if (clockMode == DISPLAY_MAX_CLOCK_MODE) {
+            probeDone = true;
+            state = State::READY;
+            return;
+        }
+        clockMode++;
+        i2cBus.SetDeviceClock(DISPLAY_ADDRESS, clockMode);
     }
     initCounter++;
+    SendCommand(Command::NOP, Command::NOP, Command::NOP, Command::NOP,
+                Command::NOP, Command::NOP, Command::NOP, Command::NOP);
+}
+
+void
+Display::LowerClock()
+{
+    if (clockMode > I2cBus::ClockMode::CLOCK_DEFAULT) {
+        clockMode--;
+        i2cBus.SetDeviceClock(DISPLAY_ADDRESS, clockMode);
+    }
+}
+
+void
+Display::HandleTransferFailure()
+{
+    transferFailures++;
+    if (transferFailures == MAX_TRANSFER_FAILURES) {
+        transferFailures = 0;
+        LowerClock();
+    }
 }
 
 bool
@@ -162,24 +336,32 @@ Display::HandleCommandTransfer(I2cBus::TransferStatus status)
     if (status == I2cBus::TransferStatus::TRANSMIT_READY ||
         status == I2cBus::TransferStatus::BYTE_TRANSMITTED) {
 
+        if (!controlSent) {
+            /* Single control byte with Co bit cleared, all the following bytes
+             * are command bytes.
+             */
+            controlSent = true;
+            i2cBus.TransmitByte(0x00);
+            return true;
+        }
         if (cmdSize) {
-            if (!controlSent) {
-                controlSent = true;
-                i2cBus.TransmitByte(0x80);
-            } else {
-                cmdSize--;
-                i2cBus.TransmitByte(cmdBuf[cmdSize]);
-                controlSent = false;
-            }
+            cmdSize--;
+            i2cBus.TransmitByte(cmdBuf[cmdSize]);
             return true;
         } else {
             /* Last byte transmitted. */
             cmdInProgress = false;
+            transferFailures = 0;
         }
         return false;
     }
     if (state == State::INITIALIZING) {
         state = State::FAILURE;
+        failureTicks = clock.GetTicks();
+    } else if (state == State::PROBING) {
+        probeDone = true;
+    } else {
+        HandleTransferFailure();
     }
     cmdSize = 0;
     cmdInProgress = false;
@@ -193,16 +375,24 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
         status != I2cBus::TransferStatus::BYTE_TRANSMITTED) {
 
         /* Output failure. */
+        DrainOutputRequest();
+        HandleTransferFailure();
+        vpLost = true;
         FinishOutputRequest();
         return false;
     }
 
     if (outReqComplete) {
         /* Viewport fully covered. */
-        FinishOutputRequest();
+        transferFailures = 0;
+        ChainOutputRequest();
         return false;
     }
 
+    if (status == I2cBus::TransferStatus::TRANSMIT_READY) {
+        chunkLeft = OUT_CHUNK_SIZE;
+    }
+
     if (outVpCtrlSent) {
         i2cBus.TransmitByte(outVpCmd);
         outVpCtrlSent = false;
@@ -216,9 +406,11 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
         u16 cmd = 0xffff;
         switch (outVpState) {
         case OutVpState::NONE:
-            if (curVp.minCol == req.vp.minCol &&
-                curVp.maxCol == req.vp.maxCol &&
-                curColumn == req.vp.minCol) {
+            MergeRequests();
+            if (!vpLost &&
+                curVp.minCol == outVp.minCol &&
+                curVp.maxCol == outVp.maxCol &&
+                curColumn == outVp.minCol) {
 
                 outVpState = OutVpState::PAGE_CMD;
                 break;
@@ -230,20 +422,21 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
             outVpState = OutVpState::COL_MIN;
             break;
         case OutVpState::COL_MIN:
-            cmd = req.vp.minCol;
+            cmd = outVp.minCol;
             curVp.minCol = cmd;
             curColumn = cmd;
             outVpState = OutVpState::COL_MAX;
             break;
         case OutVpState::COL_MAX:
-            cmd = req.vp.maxCol;
+            cmd = outVp.maxCol;
             curVp.maxCol = cmd;
             outVpState = OutVpState::PAGE_CMD;
             break;
         case OutVpState::PAGE_CMD:
-            if (curVp.minPage == req.vp.minPage &&
-                curVp.maxPage == req.vp.maxPage &&
-                curPage == req.vp.minPage) {
+            if (!vpLost &&
+                curVp.minPage == outVp.minPage &&
+                curVp.maxPage == outVp.maxPage &&
+                curPage == outVp.minPage) {
 
                 outVpState = OutVpState::DONE;
                 break;
@@ -252,14 +445,15 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
             cmd = Command::SET_PAGE_ADDRESS;
             break;
         case OutVpState::PAGE_MIN:
-            cmd = req.vp.minPage;
+            cmd = outVp.minPage;
             curVp.minPage = cmd;
             curPage = cmd;
             outVpState = OutVpState::PAGE_MAX;
             break;
         case OutVpState::PAGE_MAX:
-            cmd = req.vp.maxPage;
+            cmd = outVp.maxPage;
             curVp.maxPage = cmd;
+            vpLost = false;
             outVpState = OutVpState::DONE;
             break;
         }
@@ -278,13 +472,31 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
         return true;
     }
 
+    if (!chunkLeft) {
+        /* Continue in next transfer. Controller keeps RAM pointer so only the
+         * data control byte is needed.
+         */
+        outDataCtrlSent = false;
+        RequestOutputTransfer();
+        return false;
+    }
+    chunkLeft--;
+
     u8 data;
     if (!req.provider(curColumn, curPage, &data)) {
-        /* Request finished. */
-        FinishOutputRequest();
+        /* Request finished. Not yet started merged requests, if any, are
+         * output separately in their own viewports.
+         */
+        ChainOutputRequest();
         return false;
     }
     i2cBus.TransmitByte(data);
+    if (mergedCount && curColumn == req.vp.maxCol && curPage == req.vp.maxPage) {
+        /* Continue with the next merged request in the same window. */
+        mergedCount--;
+        req.provider = nullptr;
+        curOutReq = NextOutReq(curOutReq);
+    }
     if (curColumn == curVp.maxCol) {
         curColumn = curVp.minCol;
         if (curPage == curVp.maxPage) {
@@ -300,15 +512,42 @@ Display::HandleOutputTransfer(I2cBus::TransferStatus status)
     return true;
 }
 
+void
+Display::DrainOutputRequest()
+{
+    if (outReqComplete) {
+        /* All data already provided. */
+        return;
+    }
+    OutputReq &req = outQueue[curOutReq];
+    u8 col, page, data;
+    /* Position is tracked once the viewport is set up. */
+    if (outVpState == OutVpState::DONE) {
+        col = curColumn;
+        page = curPage;
+    } else {
+        col = req.vp.minCol;
+        page = req.vp.minPage;
+    }
+    while (req.provider(col, page, &data)) {
+        if (col == req.vp.maxCol) {
+            if (page == req.vp.maxPage) {
+                break;
+            }
+            col = req.vp.minCol;
+            page++;
+        } else {
+            col++;
+        }
+    }
+}
+
 bool
 Display::FinishOutputRequest()
 {
     outQueue[curOutReq].provider = 0;
-    if (curOutReq == SIZEOF_ARRAY(outQueue)) {
-        curOutReq = 0;
-    } else {
-        curOutReq++;
-    }
+    curOutReq = NextOutReq(curOutReq);
+    mergedCount = 0;
     outVpState = OutVpState::NONE;
     outVpCtrlSent = false;
     outInProgress = false;
@@ -317,6 +556,88 @@ Display::FinishOutputRequest()
     return outQueue[curOutReq].provider;
 }
 
+bool
+Display::IsAdjacent(const Viewport &window, const Viewport &vp)
+{
+    if (vp.minCol == window.minCol && vp.maxCol == window.maxCol) {
+        /* Pages below the window. */
+        return vp.minPage == window.maxPage + 1;
+    }
+    /* Columns to the right of single page window. */
+    return window.minPage == window.maxPage &&
+           vp.minPage == window.minPage && vp.maxPage == window.maxPage &&
+           vp.minCol == window.maxCol + 1;
+}
+
+void
+Display::MergeRequests()
+{
+    outVp = outQueue[curOutReq].vp;
+    mergedCount = 0;
+    u8 idx = curOutReq;
+    while (mergedCount < MAX_OUT_REQS - 1) {
+        idx = NextOutReq(idx);
+        OutputReq &next = outQueue[idx];
+        if (!next.provider || !IsAdjacent(outVp, next.vp) ||
+            IsScrollBlocked(next.vp)) {
+
+            break;
+        }
+        if (next.vp.minCol == outVp.minCol) {
+            outVp.maxPage = next.vp.maxPage;
+        } else {
+            outVp.maxCol = next.vp.maxCol;
+        }
+        mergedCount++;
+    }
+}
+
+bool
+Display::IsScrollOutputPending()
+{
+    u8 idx = curOutReq;
+    do {
+        if (!outQueue[idx].provider) {
+            break;
+        }
+        if (IsScrollRegion(outQueue[idx].vp)) {
+            return true;
+        }
+        idx = NextOutReq(idx);
+    } while (idx != curOutReq);
+    return false;
+}
+
+void
+Display::ChainOutputRequest()
+{
+    if (!FinishOutputRequest()) {
+        return;
+    }
+    /* Control commands are sent from the poll function, let them go first.
+     * Scrolling is deactivated there as well.
+     */
+    if (cmdInProgress || sleepCmdPending ||
+        IsScrollBlocked(outQueue[curOutReq].vp)) {
+
+        scheduler.SchedulePoll();
+        return;
+    }
+    /* Writers queue their next request while the current one is still being
+     * transferred, the bus starts the new transfer right after the current one
+     * so there is no gap waiting for the main loop.
+     */
+    RequestOutputTransfer();
+}
+
+void
+Display::RequestOutputTransfer()
+{
+    outInProgress = i2cBus.RequestTransfer(DISPLAY_ADDRESS, true,
+                                           OutputTransferHandler,
+                                           I2cBus::Priority::PRIORITY_LOW);
+}
+
 static bool
 ClearOutputHandler(u8, u8, u8 *data)
 {
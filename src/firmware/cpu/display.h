@@ -15,6 +15,11 @@
 #define DISPLAY_ADDRESS 0x3c
 #endif
 
+/** Highest I2C clock mode probed for the display, I2cBus::ClockMode. */
+#ifndef DISPLAY_MAX_CLOCK_MODE
+#define DISPLAY_MAX_CLOCK_MODE I2cBus::ClockMode::CLOCK_1M
+#endif
+
 #define DISPLAY_COLUMNS 128
 #define DISPLAY_PAGES   8
 
@@ -45,9 +50,13 @@ public:
     Poll();
 
     /** Output graphics into the provided viewport. The handler is called until
-     * it returns false or the viewport is fully covered.
+     * it returns false or the viewport is fully covered. Queued requests are
+     * executed back to back, next one is started right after the previous one
+     * is finished.
+     *
+     * @return True if queued, false if the queue is full.
      */
-    void
+    bool
     Output(Viewport vp, GraphicsProvider provider);
 
     /** Clear the entire display content. */
@@ -68,6 +77,57 @@ public:
     void
     SetSleep(bool f);
 
+    /** Scroll step interval codes. */
+    enum ScrollInterval {
+        SCROLL_2_FRAMES =   0x7,
+        SCROLL_3_FRAMES =   0x4,
+        SCROLL_4_FRAMES =   0x5,
+        SCROLL_5_FRAMES =   0x0,
+        SCROLL_25_FRAMES =  0x6,
+        SCROLL_64_FRAMES =  0x1,
+        SCROLL_128_FRAMES = 0x2,
+        SCROLL_256_FRAMES = 0x3
+    };
+
+    /** Called when scrolling is deactivated for output and the scrolled region
+     * content should be redrawn.
+     */
+    typedef void (*ScrollResetHandler)();
+
+    /** Called when the controller has been re-initialized and is ready again.
+     * Display content is not valid, everything should be redrawn.
+     */
+    typedef void (*ContentLostHandler)();
+
+    void
+    SetContentLostHandler(ContentLostHandler handler)
+    {
+        contentLostHandler = handler;
+    }
+
+    /** Start continuous horizontal scrolling performed by the display
+     * controller. All columns of the specified pages range are rotated, content
+     * leaving one side appears on the other side. Output to the scrolled
+     * pages is not possible while scrolling so the scrolling is deactivated
+     * when such output is queued and restarted after that, output to other
+     * pages proceeds without interrupting it. Display RAM content of the
+     * scrolled region is not valid after deactivation, so the reset handler
+     * should redraw it.
+     *
+     * @param minPage First page of the scrolled region.
+     * @param maxPage Last page of the scrolled region.
+     * @param left Scroll to the left when true, to the right when false.
+     * @param interval Interval between scroll steps.
+     * @param resetHandler Handler for scrolled region redrawing.
+     */
+    void
+    SetScroll(u8 minPage, u8 maxPage, bool left, ScrollInterval interval,
+              ScrollResetHandler resetHandler);
+
+    /** Stop scrolling previously started by SetScroll(). */
+    void
+    StopScroll();
+
     bool
     IsSleeping()
     {
@@ -76,12 +136,23 @@ public:
 
 private:
     enum {
-        /** Maximal number of bytes in a command. Long commands (scrolling setup)
-         * currently are not supported.
+        /** Maximal number of bytes in a command sequence. Enough for scrolling
+         * setup followed by activation command.
          */
-        MAX_CMD_SIZE = 3,
+        MAX_CMD_SIZE = 8,
         /** Maximal number of queued output requests. */
         MAX_OUT_REQS = 8,
+        /** Number of command bursts sent on each clock mode when probing. */
+        PROBE_BURSTS = 4,
+        /** Number of consecutive transfer failures to lower the clock. */
+        MAX_TRANSFER_FAILURES = 3,
+        /** Maximal number of graphics data bytes in one bus transfer. Output
+         * is continued in a new transfer so that higher priority transfers of
+         * other devices are not delayed for long.
+         */
+        OUT_CHUNK_SIZE = 64,
+        /** Delay before initialization retry after failure, clock ticks. */
+        INIT_RETRY_TICKS = TICK_FREQ * 2,
 
         /** Second byte for CHARGE_PUMP command. */
         CHARGE_PUMP_ENABLE =    0x14,
@@ -121,6 +192,10 @@ private:
         ENTIRE_DISPLAY_RAM =    0xa4,
         SET_COLUMN_ADDRESS =    0x21,
         SET_PAGE_ADDRESS =      0x22,
+        RIGHT_HORIZONTAL_SCROLL=0x26,
+        LEFT_HORIZONTAL_SCROLL =0x27,
+        DEACTIVATE_SCROLL =     0x2e,
+        ACTIVATE_SCROLL =       0x2f,
         NOP =                   0xe3
     };
 
@@ -129,6 +204,8 @@ private:
         INITIAL,
         /** Initialization in progress. */
         INITIALIZING,
+        /** Probing for the highest working bus clock. */
+        PROBING,
         /** Ready for work. */
         READY,
         /** Hardware failure, not operational. */
@@ -151,16 +228,43 @@ private:
         GraphicsProvider provider;
     } __PACKED;
 
+    ScrollResetHandler scrollResetHandler = nullptr;
+    ContentLostHandler contentLostHandler = nullptr;
     /** Command bytes. Stored in reversed order. */
     u8 cmdBuf[MAX_CMD_SIZE];
     /** Current state. */
     u8 state:4,
     /** Number of bytes in command buffer. */
-       cmdSize:2,
-    /** Control byte was sent before next command byte. */
+       cmdSize:4,
+
+    /** Control byte was sent before command bytes. */
        controlSent:1,
     /** Command is being transmitted. */
        cmdInProgress:1,
+    /** Sleep state changed, command should be sent. */
+       sleepCmdPending:1,
+    /** Scrolling requested. */
+       scrollEnabled:1,
+    /** Scrolling is currently activated in the controller. */
+       scrollActive:1,
+    /** Scroll to the left. */
+       scrollLeft:1,
+    /** Scrolling setup changed while scrolling is active. */
+       scrollChanged:1,
+       :1,
+
+    /** Scrolled pages range. */
+       scrollMinPage:3,
+       scrollMaxPage:3,
+       :2,
+    /** Scroll steps interval, ScrollInterval. */
+       scrollInterval:3,
+    /** Current bus clock mode, I2cBus::ClockMode. */
+       clockMode:3,
+    /** Clock probing finished (or failed when in PROBING state). */
+       probeDone:1,
+    /** Controller RAM pointer state is unknown after transfer failure. */
+       vpLost:1,
 
     /** Counter for initialization sequence. */
        initCounter:5,
@@ -184,12 +288,25 @@ private:
    /** Output request execution is in progress. */
        outInProgress:1,
        isSleeping:1,
-       :6;
+    /** Number of requests following the current one merged into the current
+     * output window.
+     */
+       mergedCount:3,
+    /** Consecutive transfer failures since the last successful one. */
+       transferFailures:2,
+    /** Controller re-initialized, content lost notification is pending. */
+       contentLost:1;
     OutputReq outQueue[MAX_OUT_REQS];
     /** Currently active viewport. */
     Viewport curVp;
+    /** Output window of the current request including merged requests. */
+    Viewport outVp;
     /** Pending command for output viewport setting. */
     u8 outVpCmd;
+    /** Clock ticks when failure detected. */
+    u8 failureTicks;
+    /** Data bytes left in the current output transfer chunk. */
+    u8 chunkLeft;
 
     /** Handle control commands transfers. */
     static bool
@@ -199,13 +316,15 @@ private:
     static bool
     OutputTransferHandler(I2cBus::TransferStatus status, u8 data);
 
-    /** Queue command sending.
+    /** Queue command sending. Should not be called when previous command is
+     * still in progress.
      * @param bytes Up to MAX_CMD_SIZE bytes of command data.
      */
     template <typename... TByte>
     void
     SendCommand(TByte... bytes)
     {
+        static_assert(sizeof...(bytes) <= MAX_CMD_SIZE, "Command is too long");
         cmdSize = sizeof...(bytes);
         controlSent = false;
         cmdInProgress = true;
@@ -235,9 +354,99 @@ private:
     bool
     FinishOutputRequest();
 
+    static inline u8
+    NextOutReq(u8 idx)
+    {
+        return idx == MAX_OUT_REQS - 1 ? 0 : idx + 1;
+    }
+
+    /** Check if the viewport continues the window in the display RAM
+     * addressing order, so that both can be output as a single window. Only
+     * sequential cases are accepted - the same columns range below the window,
+     * or the same single page to the right of the window. Each provider is
+     * then called for its own viewport data without interleaving.
+     */
+    static bool
+    IsAdjacent(const Viewport &window, const Viewport &vp);
+
+    /** Check whether the viewport intersects the scrolled pages range. */
+    bool
+    IsScrollRegion(const Viewport &vp)
+    {
+        return vp.minPage <= scrollMaxPage && vp.maxPage >= scrollMinPage;
+    }
+
+    /** Check whether output to the viewport is blocked by active scrolling.
+     * Pages outside of the scrolled region are written while scrolling.
+     */
+    bool
+    IsScrollBlocked(const Viewport &vp)
+    {
+        return scrollActive && IsScrollRegion(vp);
+    }
+
+    /** Check whether any queued output request targets the scrolled
+     * region.
+     */
+    bool
+    IsScrollOutputPending();
+
+    /** Merge queued requests adjacent to the current one into the output
+     * window, so that viewport setup commands and transfer start are issued
+     * once for all of them.
+     */
+    void
+    MergeRequests();
+
+    /** Finish current output request and continue with the next queued one
+     * in a new transfer. Should be called in output transfer handler only.
+     */
+    void
+    ChainOutputRequest();
+
+    /** Queue output transfer. Retried from poll if the bus queue is full. */
+    void
+    RequestOutputTransfer();
+
     void
     HandleInitialization();
 
+    /** Step the bus clock up while harmless NOP command bursts are accepted.
+     * On failure fall back one step below the last good clock and repeat
+     * initialization.
+     */
+    void
+    HandleClockProbe();
+
+    /** Restart initialization. Called after bus fault recovery and for
+     * retrying failed initialization.
+     */
+    void
+    Reset();
+
+    static void
+    _ResetHandler();
+
+    /** Switch to lower clock mode. */
+    void
+    LowerClock();
+
+    /** Account transfer failure, switch to lower clock mode if failures
+     * persist. Single failures are tolerated since they may be transient.
+     */
+    void
+    HandleTransferFailure();
+
+    /** Call provider of the failed output request for the remaining data so
+     * that its owner completes the request and is not stalled.
+     */
+    void
+    DrainOutputRequest();
+
+    /** Send pending sleep and scrolling control commands if any. */
+    void
+    HandleControl();
+
     bool
     HandleCommandTransfer(I2cBus::TransferStatus status);
 
@@ -0,0 +1,119 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file draw_list.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+DrawList::DrawList(Page *page, const Op *ops, u8 numOps):
+    ops(ops), numOps(numOps)
+{
+    outstanding = 0;
+    waiting = false;
+    waitingAll = false;
+    inProgress = false;
+    closeRequested = false;
+    page->drawList = this;
+}
+
+void
+DrawList::Poll()
+{
+    AtomicSection as;
+    if (inProgress || !dirtyMask || closeRequested) {
+        return;
+    }
+    inProgress = true;
+    curOp = numOps;
+    Run();
+}
+
+bool
+DrawList::Close()
+{
+    AtomicSection as;
+    closeRequested = true;
+    return outstanding == 0;
+}
+
+void
+DrawList::Run()
+{
+    Page *page = app.CurPage();
+    while (true) {
+        if (closeRequested) {
+            inProgress = false;
+            return;
+        }
+        if (outstanding >= MAX_OUTSTANDING) {
+            /* Resume as soon as one slot is freed. */
+            waiting = true;
+            waitingAll = false;
+            return;
+        }
+        if (curOp >= numOps) {
+            /* Pass finished. Start next one after all its output is done. */
+            if (outstanding) {
+                waiting = true;
+                waitingAll = true;
+                return;
+            }
+            if (!dirtyMask) {
+                inProgress = false;
+                return;
+            }
+            passMask = dirtyMask;
+            dirtyMask = 0;
+            curOp = 0;
+        }
+
+        Op op;
+        memcpy_P(&op, &ops[curOp], sizeof(op));
+        curOp++;
+        if (!(op.mask & passMask)) {
+            continue;
+        }
+
+        u8 res;
+        if (op.func) {
+            res = op.func(page);
+        } else {
+            bitmapWriter.Write(op.column, op.page, op.bitmap, false,
+                               _DoneHandler);
+            res = Result::CONTINUE;
+        }
+        if (res == Result::SKIP) {
+            continue;
+        }
+        outstanding++;
+        if (res == Result::WAIT) {
+            waiting = true;
+            waitingAll = true;
+            return;
+        }
+    }
+}
+
+void
+DrawList::_DoneHandler()
+{
+    app.CurPage()->drawList->DoneHandler();
+}
+
+void
+DrawList::DoneHandler()
+{
+    AtomicSection as;
+    outstanding--;
+    if (waiting &&
+        (outstanding == 0 || (!waitingAll && outstanding < MAX_OUTSTANDING))) {
+
+        waiting = false;
+        Run();
+    }
+}
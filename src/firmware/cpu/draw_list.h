@@ -0,0 +1,146 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file draw_list.h
+ * Asynchronous draw sequence engine for pages.
+ */
+
+#ifndef DRAW_LIST_H_
+#define DRAW_LIST_H_
+
+class Page;
+
+/** Draws page elements described by a table of draw operations. Each
+ * operation is bound to dirty bits, only operations for invalidated elements
+ * are issued. Operations which source data stays valid until the output is
+ * complete do not block the sequence so several of them may be queued to the
+ * writers at once.
+ */
+class DrawList {
+public:
+    /** Draw operation result. */
+    enum Result {
+        /** Nothing was output. */
+        SKIP,
+        /** Output issued, next operation should wait for its completion (e.g.
+         * shared buffer is used for the output).
+         */
+        WAIT,
+        /** Output issued, next operation can be issued right away. */
+        CONTINUE
+    };
+
+    /** Custom draw operation. Output should be issued with _DoneHandler() as
+     * completion handler.
+     *
+     * @return Result code.
+     */
+    typedef u8 (*OpFunc)(Page *page);
+
+    /** Draw operation. Stored in program memory. */
+    struct Op {
+        /** Dirty bits the operation is issued for. */
+        u16 mask;
+        /** Custom operation. Null for bitmap operation. */
+        OpFunc func;
+        /** Bitmap in program memory for bitmap operation. */
+        const Bitmap *bitmap;
+        u8 column, page;
+    } __PACKED;
+
+    /** Make custom operation table entry. */
+    static constexpr Op
+    CustomOp(u16 mask, OpFunc func)
+    {
+        return Op{mask, func, nullptr, 0, 0};
+    }
+
+    /** Make bitmap operation table entry. */
+    static constexpr Op
+    BitmapOp(u16 mask, const Bitmap *bitmap, u8 column, u8 page)
+    {
+        return Op{mask, nullptr, bitmap, column, page};
+    }
+
+    /** Make custom operation from page method. */
+    template <class TPage, u8 (TPage::*method)()>
+    static u8
+    Method(Page *page)
+    {
+        return (static_cast<TPage *>(page)->*method)();
+    }
+
+    /** @param page Page to attach to.
+     *  @param ops Operations in program memory in drawing order.
+     *  @param numOps Number of operations.
+     */
+    DrawList(Page *page, const Op *ops, u8 numOps);
+
+    /** Mark elements dirty. Drawing is started from the page poll function. */
+    void
+    Invalidate(u16 mask)
+    {
+        adk::AtomicSection as;
+        dirtyMask |= mask;
+    }
+
+    void
+    Poll();
+
+    /** Stop drawing.
+     *
+     * @return True if no output in progress, false if should be called later
+     *      again.
+     */
+    bool
+    Close();
+
+    /** Check if Close() was called. */
+    bool
+    IsClosed()
+    {
+        return closeRequested;
+    }
+
+    /** Completion handler for the operations output. */
+    static void
+    _DoneHandler();
+
+    void
+    DoneHandler();
+
+private:
+    enum {
+        /** Maximal number of not completed operations. Keeps writers queues
+         * from overflowing.
+         */
+        MAX_OUTSTANDING = 4
+    };
+
+    const Op *ops;
+    /** Elements to draw in next pass. */
+    u16 dirtyMask = 0,
+    /** Elements to draw in current pass. */
+        passMask;
+    u8 numOps,
+    /** Next operation index. */
+       curOp;
+    /** Number of issued and not completed operations. */
+    u8 outstanding:3,
+    /** Waiting for completion of outstanding operations. */
+       waiting:1,
+    /** Waiting for all outstanding operations, not just a free slot. */
+       waitingAll:1,
+       inProgress:1,
+       closeRequested:1,
+       :1;
+
+    /** Issue operations until blocked. */
+    void
+    Run();
+} __PACKED;
+
+#endif /* DRAW_LIST_H_ */
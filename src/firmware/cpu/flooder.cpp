@@ -19,20 +19,22 @@ Time EEMEM Flooder::eeMinSunriseTime {7, 0},
            Flooder::eeFloodDuration{0, 1},
            Flooder::eeFloodPeriod{24, 0},
            Flooder::eeMaxSunsetTime{22, 0};
+i8 EEMEM Flooder::eeLatitude = 50;
+constexpr Time Flooder::LIGHT_GATE;
 
 Flooder::Flooder()
 {
     isDaylight = false;
     sunsetSeen = false;
-    dayOfWeek = rtc.GetDayOfWeek();
+    lastDay = 0;
     status = Status::IDLE;
 }
 
 void
 Flooder::Initialize()
 {
+    rtc.Subscribe(Rtc::GROUP_DATE);
     SchedulePoll();
-    scheduler.ScheduleTask(_SchedulePoll, SCHEDULE_POLL_PERIOD);
 }
 
 Time
@@ -47,6 +49,7 @@ void
 Flooder::SetMinSunriseTime(Time t)
 {
     eeprom_update_block(&t, &eeMinSunriseTime, sizeof(t));
+    SchedulePoll();
 }
 
 Time
@@ -61,6 +64,7 @@ void
 Flooder::SetFirstFloodDelay(Time t)
 {
     eeprom_update_block(&t, &eeFirstFloodDelay, sizeof(t));
+    SchedulePoll();
 }
 
 Time
@@ -89,6 +93,7 @@ void
 Flooder::SetFloodPeriod(Time t)
 {
     eeprom_update_block(&t, &eeFloodPeriod, sizeof(t));
+    SchedulePoll();
 }
 
 Time
@@ -103,6 +108,38 @@ void
 Flooder::SetMaxSunsetTime(Time t)
 {
     eeprom_update_block(&t, &eeMaxSunsetTime, sizeof(t));
+    SchedulePoll();
+}
+
+i8
+Flooder::GetLatitude()
+{
+    return eeprom_read_byte(reinterpret_cast<u8 *>(&eeLatitude));
+}
+
+void
+Flooder::SetLatitude(i8 latitude)
+{
+    eeprom_update_byte(reinterpret_cast<u8 *>(&eeLatitude), latitude);
+    SchedulePoll();
+}
+
+void
+Flooder::UpdateDaylightWindow()
+{
+    u16 start = GetMinSunriseTime().TotalMinutes();
+    u16 end = GetMaxSunsetTime().TotalMinutes();
+    if (end > start) {
+        u16 noon = (start + end) / 2;
+        u16 halfDay = solar::GetDayLength(rtc.GetDate().GetDayOfYear(),
+                                          GetLatitude()) / 2;
+        if (noon - start > halfDay) {
+            start = noon - halfDay;
+            end = noon + halfDay;
+        }
+    }
+    sunriseTime = Time{static_cast<u8>(start / 60), static_cast<u8>(start % 60)};
+    sunsetTime = Time{static_cast<u8>(end / 60), static_cast<u8>(end % 60)};
 }
 
 const char *
@@ -131,6 +168,8 @@ Flooder::GetErrorString()
     switch (errorCode) {
     case ErrorCode::LOW_WATER:
         return strings.FlooderError_LowWater;
+    case ErrorCode::NUTRIENTS_RANGE:
+        return strings.FlooderError_NutrientsRange;
     }
     return strings.NoValue;
 }
@@ -151,6 +190,11 @@ Flooder::StartFlooding()
         errorCode = ErrorCode::LOW_WATER;
         return;
     }
+    if (!nutrients.IsInRange()) {
+        status = Status::FAILURE;
+        errorCode = ErrorCode::NUTRIENTS_RANGE;
+        return;
+    }
     status = Status::FLOODING;
     startLevel = lastWaterLevel;
     floodWaitDone = false;
@@ -285,6 +329,7 @@ Flooder::FloodPoll()
             status = Status::IDLE;
             lastWaterLevel = newLevel;
             lastFloodTime = rtc.GetTime().GetTime();
+            SchedulePoll();
             return 0;
         }
 
@@ -306,23 +351,41 @@ Flooder::_FloodPoll()
     return flooder.FloodPoll();
 }
 
-u16
+void
 Flooder::SchedulePoll()
 {
     Time curTime = rtc.GetTime().GetTime();
-    u8 newDow = rtc.GetDayOfWeek();
-    if (newDow != dayOfWeek) {
-        dayOfWeek = newDow;
+    u8 newDay = rtc.GetDate().day;
+    if (newDay != lastDay) {
+        lastDay = newDay;
         sunsetSeen = false;
     }
+    /* Settings might be changed as well. */
+    UpdateDaylightWindow();
+    isAmbientDaylight = light.IsAmbientDaylight();
+
+    /* Light sensors are trusted only in the gate windows around the estimated
+     * times, the window end forces the event if no light change was seen.
+     */
+    Time sunriseGateStart = sunriseTime - LIGHT_GATE;
+    Time minSunriseTime = GetMinSunriseTime();
+    if (sunriseGateStart < minSunriseTime) {
+        sunriseGateStart = minSunriseTime;
+    }
+    Time sunriseGateEnd = sunriseTime + LIGHT_GATE;
+    Time sunsetGateStart = sunsetTime - LIGHT_GATE;
+    Time sunsetGateEnd = sunsetTime + LIGHT_GATE;
+    Time maxSunsetTime = GetMaxSunsetTime();
+    if (sunsetGateEnd > maxSunsetTime) {
+        sunsetGateEnd = maxSunsetTime;
+    }
 
     /* Detect sunrise. */
     if (!isDaylight && !sunsetSeen) {
-        //XXX use light sensors
-        Time minSunriseTime = GetMinSunriseTime();
-        if (curTime >= minSunriseTime) {
+        if (curTime >= sunriseGateEnd ||
+            (isAmbientDaylight && curTime >= sunriseGateStart)) {
+
             isDaylight = true;
-            isAmbientDaylight = true;
             lastSunriseTime = curTime;
             lastFloodTime = Time{0, 0};
         }
@@ -330,11 +393,10 @@ Flooder::SchedulePoll()
 
     /* Detect sunset. */
     if (isDaylight) {
-        //XXX use light sensors
-        Time maxSunsetTime = GetMaxSunsetTime();
-        if (curTime >= maxSunsetTime) {
+        if (curTime >= sunsetGateEnd ||
+            (!isAmbientDaylight && curTime >= sunsetGateStart)) {
+
             isDaylight = false;
-            isAmbientDaylight = false;
             sunsetSeen = true;
             lastSunsetTime = curTime;
             lastFloodTime = Time{0, 0};
@@ -348,13 +410,57 @@ Flooder::SchedulePoll()
         }
     }
 
-    return SCHEDULE_POLL_PERIOD;
+    /* Wake up on the nearest boundary, day change is always checked. */
+    Time boundaries[3];
+    u8 numBoundaries = 0;
+    if (!isDaylight && !sunsetSeen) {
+        if (curTime < sunriseGateStart) {
+            boundaries[numBoundaries++] = sunriseGateStart;
+        }
+        boundaries[numBoundaries++] = sunriseGateEnd;
+    }
+    if (isDaylight) {
+        if (curTime < sunsetGateStart) {
+            boundaries[numBoundaries++] = sunsetGateStart;
+        }
+        boundaries[numBoundaries++] = sunsetGateEnd;
+    }
+    if (status == Status::IDLE) {
+        Time floodTime = GetNextFloodTime();
+        if (floodTime) {
+            boundaries[numBoundaries++] = floodTime;
+        }
+    }
+    Time alarmTime{0, 0};
+    u16 minDelay = MinutesUntil(curTime, alarmTime);
+    for (u8 i = 0; i < numBoundaries; i++) {
+        u16 delay = MinutesUntil(curTime, boundaries[i]);
+        if (delay < minDelay) {
+            minDelay = delay;
+            alarmTime = boundaries[i];
+        }
+    }
+    if (alarmTime.hour >= 24) {
+        alarmTime.hour -= 24;
+    }
+    rtc.SetAlarm(Rtc::ALARM_2, Rtc::Time{alarmTime.hour, alarmTime.min, 0},
+                 _AlarmHandler);
+}
+
+void
+Flooder::_AlarmHandler()
+{
+    flooder.SchedulePoll();
 }
 
 u16
-Flooder::_SchedulePoll()
+Flooder::MinutesUntil(Time curTime, Time t)
 {
-    return flooder.SchedulePoll();
+    u16 cur = curTime.TotalMinutes(), target = t.TotalMinutes() % DAY_MINUTES;
+    if (target > cur) {
+        return target - cur;
+    }
+    return target + DAY_MINUTES - cur;
 }
 
 Time
@@ -367,7 +473,7 @@ Flooder::GetNextFloodTime()
         return lastSunriseTime + GetFirstFloodDelay();
     }
     Time t = lastFloodTime + GetFloodPeriod();
-    if (t > GetMaxSunsetTime()) {
+    if (t > sunsetTime) {
         return Time{0, 0};
     }
     return t;
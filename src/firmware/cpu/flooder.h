@@ -22,7 +22,9 @@ public:
 
     enum ErrorCode {
         /** Too low water level for flooding start. */
-        LOW_WATER
+        LOW_WATER,
+        /** Nutrient solution EC or pH is out of the acceptable range. */
+        NUTRIENTS_RANGE
     };
 
     Flooder();
@@ -97,6 +99,30 @@ public:
     void
     SetMaxSunsetTime(Time t);
 
+    /** Latitude for daylight duration estimation, degrees. */
+    static i8
+    GetLatitude();
+
+    void
+    SetLatitude(i8 latitude);
+
+    /** Expected sunrise time for the current date. The daylight window is
+     * estimated by the solar model and is centered in the configured window
+     * which also limits it.
+     */
+    Time
+    GetSunriseTime()
+    {
+        return sunriseTime;
+    }
+
+    /** Expected sunset time for the current date. */
+    Time
+    GetSunsetTime()
+    {
+        return sunsetTime;
+    }
+
     Time
     GetLastSunriseTime()
     {
@@ -109,14 +135,18 @@ public:
         return lastSunsetTime;
     }
 
-    /** Is currently daylight time according to ambient light sensors. */
+    /** Is currently daylight time according to ambient light sensors. Updated
+     * on each schedule evaluation.
+     */
     bool
     IsAmbientDaylight()
     {
         return isAmbientDaylight;
     }
 
-    /** Is currently daylight time (possibly extended by lighting). */
+    /** Is currently daylight time (possibly extended by lighting since
+     * ambient light is not detected while the lamp is on).
+     */
     bool
     IsDaylight()
     {
@@ -129,15 +159,27 @@ public:
     Time
     GetNextFloodTime();
 
+    /** Re-evaluate flooding schedule and program RTC alarm for the next
+     * schedule boundary. Should be called when schedule settings or current
+     * time are changed.
+     */
+    void
+    SchedulePoll();
+
 private:
     enum {
         /** Minimal water level to start flooding, in percents. */
         MIN_START_WATER = 95,
         /** Control polling period. */
         POLL_PERIOD = TASK_DELAY_S(2),
-        /** Polling period for flooding schedule. */
-        SCHEDULE_POLL_PERIOD = TASK_DELAY_S(60)
+        /** Minutes in a day. */
+        DAY_MINUTES = 24 * 60
     };
+
+    /** Ambient light changes are accepted within this time around the
+     * estimated sunrise and sunset.
+     */
+    static constexpr Time LIGHT_GATE{1, 30};
     u8 status:3,
        errorCode:3,
        isDaylight:1,
@@ -146,10 +188,12 @@ private:
        siphonReached:1,
        isAmbientDaylight:1,
        sunsetSeen:1,
-       dayOfWeek:3,
        /** Extended delay when changing pump mode. */
        extendedPollDelay:1,
-       :1;
+       :4;
+    /** Day of month when the schedule was last evaluated. */
+    u8 lastDay:5,
+       :3;
     /** Water level when cycle started. */
     u8 startLevel = 0;
     /** Water level on most recent gauge reading. */
@@ -167,6 +211,8 @@ private:
 
     Time lastSunriseTime{0, 0}, lastSunsetTime{0, 0}, lastFloodTime {0, 0},
          floodDelayTime;
+    /** Daylight window for the current date. */
+    Time sunriseTime{0, 0}, sunsetTime{0, 0};
 
     /** Throttle value to use when pump is on. */
     static u8 EEMEM eePumpThrottle,
@@ -177,6 +223,7 @@ private:
                       eeFloodDuration,
                       eeFloodPeriod,
                       eeMaxSunsetTime;
+    static i8 EEMEM eeLatitude;
 
     static u16
     _FloodPoll();
@@ -184,11 +231,21 @@ private:
     u16
     FloodPoll();
 
-    static u16
-    _SchedulePoll();
+    /** Estimate daylight window for the current date. */
+    void
+    UpdateDaylightWindow();
 
-    u16
-    SchedulePoll();
+    /** Schedule alarm handler. */
+    static void
+    _AlarmHandler();
+
+    /** Get number of minutes until the specified time of day.
+     *
+     * @return Value in range 1..DAY_MINUTES, current minute is counted as the
+     *      next day.
+     */
+    static u16
+    MinutesUntil(Time curTime, Time t);
 
 } __PACKED;
 
@@ -8,7 +8,7 @@
  * Font data definition.
  */
 
-static const unsigned char fontData[96 + 16][6] PROGMEM = {
+static constexpr unsigned char fontData[96 + 16][6] PROGMEM = {
     /* 16 custom characters. */
 
     { // '\x10' degrees symbol
@@ -910,3 +910,145 @@ static const unsigned char fontData[96 + 16][6] PROGMEM = {
         0b00000000}
 
 };
+
+/** Characters available in large fonts. */
+static constexpr char largeFontCharMap[] PROGMEM = "0123456789:%.- ";
+
+/** Compile-time generation of large fonts by scaling the base font glyphs.
+ * Empty columns are trimmed so the resulting fonts are proportional.
+ */
+namespace font_gen {
+
+/** First character in the base font. */
+constexpr u8 BASE_FIRST_CHAR = 0x10;
+/** Width of empty glyph (space) in base font columns. */
+constexpr u8 EMPTY_GLYPH_WIDTH = 3;
+constexpr u8 NUM_CHARS = sizeof(largeFontCharMap) - 1;
+
+constexpr u8
+BaseCol(char c, u8 col)
+{
+    return fontData[c - BASE_FIRST_CHAR][col];
+}
+
+/** First non-empty column in base glyph, FONT_WIDTH if glyph is empty. */
+constexpr u8
+FirstCol(char c, u8 col = 0)
+{
+    return col >= FONT_WIDTH || BaseCol(c, col) ? col : FirstCol(c, col + 1);
+}
+
+/** Column after the last non-empty column in base glyph. */
+constexpr u8
+EndCol(char c, u8 col = FONT_WIDTH)
+{
+    return col == 0 || BaseCol(c, col - 1) ? col : EndCol(c, col - 1);
+}
+
+constexpr bool
+IsEmpty(char c)
+{
+    return FirstCol(c) == FONT_WIDTH;
+}
+
+/** Trimmed glyph width in base font columns. */
+constexpr u8
+BaseWidth(char c)
+{
+    return IsEmpty(c) ? EMPTY_GLYPH_WIDTH : EndCol(c) - FirstCol(c);
+}
+
+/** First used column of base glyph. */
+constexpr u8
+BaseStart(char c)
+{
+    return IsEmpty(c) ? 0 : FirstCol(c);
+}
+
+/** Get the specified page of scaled base column byte. */
+constexpr u8
+ScaledByte(u8 b, u8 scale, u8 page, u8 bit = 0)
+{
+    return bit >= 8 ? 0 :
+        (((b >> ((page * 8 + bit) / scale)) & 1) << bit) |
+        ScaledByte(b, scale, page, bit + 1);
+}
+
+constexpr u16
+GlyphSize(u8 scale, u8 idx)
+{
+    /* Scale times wider, scale pages high. */
+    return BaseWidth(largeFontCharMap[idx]) * scale * scale;
+}
+
+constexpr u16
+GlyphOffset(u8 scale, u8 idx)
+{
+    return idx == 0 ? 0 :
+        GlyphOffset(scale, idx - 1) + GlyphSize(scale, idx - 1);
+}
+
+/** Find glyph index the specified data byte belongs to. */
+constexpr u8
+FindGlyph(u8 scale, u16 n, u8 idx = 0)
+{
+    return n < GlyphOffset(scale, idx + 1) ? idx : FindGlyph(scale, n, idx + 1);
+}
+
+/** Get byte of glyph data.
+ *
+ * @param c Glyph character.
+ * @param pos Byte position in the glyph data.
+ * @param width Scaled glyph width.
+ */
+constexpr u8
+GlyphByte(u8 scale, char c, u16 pos, u8 width)
+{
+    return ScaledByte(BaseCol(c, BaseStart(c) + (pos % width) / scale),
+                      scale, pos / width);
+}
+
+/** Get byte of the font data. */
+constexpr u8
+DataByte(u8 scale, u16 n)
+{
+    return GlyphByte(scale, largeFontCharMap[FindGlyph(scale, n)],
+                     n - GlyphOffset(scale, FindGlyph(scale, n)),
+                     BaseWidth(largeFontCharMap[FindGlyph(scale, n)]) * scale);
+}
+
+template <u8 scale, class TSeq>
+struct ScaledData;
+
+template <u8 scale, u16... n>
+struct ScaledData<scale, meta::IndexSeq<n...>> {
+    static const u8 data[sizeof...(n)];
+};
+
+template <u8 scale, u16... n>
+const u8 ScaledData<scale, meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { DataByte(scale, n)... };
+
+template <u8 scale, class TSeq>
+struct ScaledOffsets;
+
+template <u8 scale, u16... n>
+struct ScaledOffsets<scale, meta::IndexSeq<n...>> {
+    static const u16 data[sizeof...(n)];
+};
+
+template <u8 scale, u16... n>
+const u16 ScaledOffsets<scale, meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { GlyphOffset(scale, n)... };
+
+/** Base font scaled by the specified factor. */
+template <u8 scale>
+struct ScaledFont {
+    using Data = ScaledData<scale, typename meta::MakeIndexSeq<
+        GlyphOffset(scale, NUM_CHARS)>::Type>;
+    /** Additional entry in the end for the last glyph size. */
+    using Offsets = ScaledOffsets<scale, typename meta::MakeIndexSeq<
+        NUM_CHARS + 1>::Type>;
+};
+
+} /* namespace font_gen */
@@ -12,38 +12,174 @@ using namespace adk;
 
 I2cBus i2cBus;
 
+/** SCL frequency is ADK_MCU_FREQ / (16 + 2 * TWBR) with unit prescaler. */
+#define I2C_TWBR(__freq) ((ADK_MCU_FREQ / (__freq) - 16) / 2)
+
+static const u8 clockTwbr[I2cBus::ClockMode::NUM_CLOCK_MODES] PROGMEM = {
+    I2C_TWBR(100000),
+    I2C_TWBR(400000),
+    I2C_TWBR(600000),
+    I2C_TWBR(800000),
+    I2C_TWBR(1000000)
+};
+
 I2cBus::I2cBus()
 {
 #ifdef I2C_USE_PULLUP
     AVR_BIT_SET8(AVR_REG_PORT(I2C_SCL_PORT), I2C_SCL_PIN);
     AVR_BIT_SET8(AVR_REG_PORT(I2C_SDA_PORT), I2C_SDA_PIN);
 #endif
-    /* 400kHz clock. */
-    TWBR = 17;
+    EnableHw();
+}
+
+void
+I2cBus::EnableHw()
+{
+    TWBR = GetTwbr(ClockMode::CLOCK_DEFAULT);
     TWCR = _BV(TWIE) | _BV(TWEN);
 }
 
+u8
+I2cBus::GetTwbr(u8 mode)
+{
+    return pgm_read_byte(&clockTwbr[mode]);
+}
+
+I2cBus::Device *
+I2cBus::FindDevice(u8 sla, bool alloc)
+{
+    sla &= ~1;
+    Device *freeSlot = nullptr;
+    for (Device &dev: devices) {
+        if (dev.sla == sla) {
+            return &dev;
+        }
+        if (!dev.sla && !freeSlot) {
+            freeSlot = &dev;
+        }
+    }
+    if (!alloc || !freeSlot) {
+        return nullptr;
+    }
+    freeSlot->sla = sla;
+    freeSlot->twbr = GetTwbr(ClockMode::CLOCK_DEFAULT);
+    freeSlot->errorCount = 0;
+    freeSlot->resetHandler = nullptr;
+    return freeSlot;
+}
+
+void
+I2cBus::RegisterDevice(u8 address, ResetHandler resetHandler)
+{
+    AtomicSection as;
+    Device *dev = FindDevice(address << 1, true);
+    if (dev) {
+        dev->resetHandler = resetHandler;
+    }
+}
+
+void
+I2cBus::SetDeviceClock(u8 address, u8 mode)
+{
+    AtomicSection as;
+    Device *dev = FindDevice(address << 1, true);
+    if (dev) {
+        dev->twbr = GetTwbr(mode);
+    }
+}
+
+u8
+I2cBus::GetErrorCount(u8 address)
+{
+    AtomicSection as;
+    Device *dev = FindDevice(address << 1);
+    return dev ? dev->errorCount : 0;
+}
+
+void
+I2cBus::CountError(u8 sla)
+{
+    Device *dev = FindDevice(sla);
+    if (dev && dev->errorCount != 0xff) {
+        dev->errorCount++;
+    }
+}
+
+void
+I2cBus::SetClock(u8 sla)
+{
+    Device *dev = FindDevice(sla);
+    TWBR = dev ? dev->twbr : GetTwbr(ClockMode::CLOCK_DEFAULT);
+}
+
 void
 I2cBus::Poll()
 {
     AtomicSection as;
-    if (state == State::IDLE && IsHwIdle()) {
-        TransferReq &req = reqQueue[queuePtr];
-        if (!req.handler) {
-            return;
+    u8 ticks = clock.GetTicks();
+    if (state != State::IDLE || !IsHwIdle()) {
+        /* Either transfer or bus release (STOP) is in progress. Slave holding
+         * SDA or SCL lines or missed interrupt stall it forever.
+         */
+        if (static_cast<u8>(ticks - lastActivity) > TIMEOUT_TICKS) {
+            Recover();
+            lastActivity = ticks;
         }
-        if (req.sla & 1) {
-            state = State::SLA_R;
-        } else {
-            state = State::SLA_W;
+        return;
+    }
+    lastActivity = ticks;
+    if (SelectRequest()) {
+        StartTransfer();
+    }
+}
+
+bool
+I2cBus::SelectRequest()
+{
+    if (!reqQueue[queuePtr].handler) {
+        return false;
+    }
+    /* Pending requests are contiguous starting from the queue pointer since
+     * slots are allocated from it and freed in the head only.
+     */
+    u8 selected = queuePtr, idx = queuePtr;
+    u8 priority = reqQueue[queuePtr].priority;
+    while (true) {
+        idx = idx == I2C_REQ_QUEUE_SIZE - 1 ? 0 : idx + 1;
+        if (idx == queuePtr || !reqQueue[idx].handler) {
+            break;
+        }
+        if (reqQueue[idx].priority > priority) {
+            selected = idx;
+            priority = reqQueue[idx].priority;
         }
-        SendStart();
     }
+    /* Shift preceding requests to keep the order of the rest. */
+    TransferReq req = reqQueue[selected];
+    while (selected != queuePtr) {
+        u8 prev = selected == 0 ? I2C_REQ_QUEUE_SIZE - 1 : selected - 1;
+        reqQueue[selected] = reqQueue[prev];
+        selected = prev;
+    }
+    reqQueue[queuePtr] = req;
+    return true;
+}
+
+void
+I2cBus::StartTransfer()
+{
+    if (reqQueue[queuePtr].sla & 1) {
+        state = State::SLA_R;
+    } else {
+        state = State::SLA_W;
+    }
+    SendStart();
 }
 
 void
 I2cBus::HandleInterrupt()
 {
+    lastActivity = clock.GetTicks();
     u8 hwStatus = TWSR;
     TransferReq &req = reqQueue[queuePtr];
     u8 rcvd = 0;
@@ -131,6 +267,12 @@ I2cBus::HandleInterrupt()
     }
 
     if (status != TransferStatus::NONE) {
+        if (status == TransferStatus::TRANSMIT_FAILED ||
+            status == TransferStatus::RECEIVE_FAILED ||
+            status == TransferStatus::NACK) {
+
+            CountError(req.sla);
+        }
         bool ret = false;
         if (status != TransferStatus::READ_CLOSED) {
             ret = req.handler(status, rcvd);
@@ -139,12 +281,7 @@ I2cBus::HandleInterrupt()
             (state != State::READ || hwStatus == HwStatus::DATA_RCVD_NACK)) {
 
             /* Send repeated start. */
-            if (reqQueue[queuePtr].sla & 1) {
-                state = State::SLA_R;
-            } else {
-                state = State::SLA_W;
-            }
-            SendStart();
+            StartTransfer();
             instantTransferPending = false;
         } else if (!ret || IsClosingStatus(status)) {
             if (!ret && !IsClosingStatus(status) &&
@@ -179,7 +316,7 @@ I2cBus::HandleInterrupt()
 }
 
 void
-I2cBus::CloseTransfer()
+I2cBus::ReleaseRequest()
 {
     TransferReq &req = reqQueue[queuePtr];
     req.handler = 0;
@@ -188,19 +325,121 @@ I2cBus::CloseTransfer()
     } else {
         queuePtr++;
     }
+}
+
+void
+I2cBus::CloseTransfer()
+{
+    ReleaseRequest();
+    if (SelectRequest()) {
+        /* Continue with the next transfer right away, no gap on the bus
+         * waiting for the main loop.
+         */
+        StartTransfer();
+        return;
+    }
     if (state != State::SLA_R && state != State::SLA_W) {
         SendStop();
     }
     state = State::IDLE;
 }
 
+void
+I2cBus::Recover()
+{
+    TransferReq &req = reqQueue[queuePtr];
+    if (state != State::IDLE && req.handler) {
+        CountError(req.sla);
+        TransferHandler handler = req.handler;
+        TransferStatus status = (req.sla & 1) ? TransferStatus::RECEIVE_FAILED :
+                                                TransferStatus::TRANSMIT_FAILED;
+        instantTransferPending = false;
+        ReleaseRequest();
+        state = State::IDLE;
+        /* Handlers do not request instant transfer on failure. */
+        handler(status, 0);
+    }
+    state = State::IDLE;
+    /* Devices are re-initialized below so queued requests are stale as well,
+     * fail them so that their owners do not keep them accounted as pending.
+     * Failure handlers do not queue new requests, the loop is bounded anyway.
+     */
+    for (u8 i = 0; i < I2C_REQ_QUEUE_SIZE && reqQueue[queuePtr].handler; i++) {
+        TransferReq &req = reqQueue[queuePtr];
+        TransferHandler handler = req.handler;
+        TransferStatus status = (req.sla & 1) ? TransferStatus::RECEIVE_FAILED :
+                                                TransferStatus::TRANSMIT_FAILED;
+        ReleaseRequest();
+        handler(status, 0);
+    }
+
+    TWCR = 0;
+    ClearBus();
+    EnableHw();
+    if (recoveryCount != 0xff) {
+        recoveryCount++;
+    }
+
+    for (Device &dev: devices) {
+        if (dev.sla && dev.resetHandler) {
+            dev.resetHandler();
+        }
+    }
+}
+
+/** Release line, it is pulled up. */
+#ifdef I2C_USE_PULLUP
+#define I2C_LINE_RELEASE(__port, __pin) do { \
+    AVR_BIT_CLR8(AVR_REG_DDR(__port), __pin); \
+    AVR_BIT_SET8(AVR_REG_PORT(__port), __pin); \
+} while (false)
+#else
+#define I2C_LINE_RELEASE(__port, __pin) \
+    AVR_BIT_CLR8(AVR_REG_DDR(__port), __pin)
+#endif
+
+/** Drive line low. */
+#define I2C_LINE_LOW(__port, __pin) do { \
+    AVR_BIT_CLR8(AVR_REG_PORT(__port), __pin); \
+    AVR_BIT_SET8(AVR_REG_DDR(__port), __pin); \
+} while (false)
+
+void
+I2cBus::ClearBus()
+{
+    I2C_LINE_RELEASE(I2C_SDA_PORT, I2C_SDA_PIN);
+    I2C_LINE_RELEASE(I2C_SCL_PORT, I2C_SCL_PIN);
+    _delay_us(BUS_CLEAR_DELAY_US);
+    /* Slave holding SDA low releases it after the byte it transmits is
+     * clocked out.
+     */
+    for (u8 i = 0; i < BUS_CLEAR_PULSES; i++) {
+        if (AVR_BIT_GET8(AVR_REG_PIN(I2C_SDA_PORT), I2C_SDA_PIN)) {
+            break;
+        }
+        I2C_LINE_LOW(I2C_SCL_PORT, I2C_SCL_PIN);
+        _delay_us(BUS_CLEAR_DELAY_US);
+        I2C_LINE_RELEASE(I2C_SCL_PORT, I2C_SCL_PIN);
+        _delay_us(BUS_CLEAR_DELAY_US);
+    }
+    /* STOP condition - SDA rising while SCL is high. */
+    I2C_LINE_LOW(I2C_SCL_PORT, I2C_SCL_PIN);
+    I2C_LINE_LOW(I2C_SDA_PORT, I2C_SDA_PIN);
+    _delay_us(BUS_CLEAR_DELAY_US);
+    I2C_LINE_RELEASE(I2C_SCL_PORT, I2C_SCL_PIN);
+    _delay_us(BUS_CLEAR_DELAY_US);
+    I2C_LINE_RELEASE(I2C_SDA_PORT, I2C_SDA_PIN);
+    _delay_us(BUS_CLEAR_DELAY_US);
+}
+
 ISR(TWI_vect)
 {
     i2cBus.HandleInterrupt();
 }
 
 bool
-I2cBus::RequestTransfer(u8 address, bool isTransmit, TransferHandler handler)
+I2cBus::RequestTransfer(u8 address, bool isTransmit, TransferHandler handler,
+                        u8 priority)
 {
     AtomicSection as;
     /* Find queue free slot. */
@@ -221,6 +460,7 @@ I2cBus::RequestTransfer(u8 address, bool isTransmit, TransferHandler handler)
     }
     reqQueue[idx].handler = handler;
     reqQueue[idx].sla = (address << 1) | (isTransmit ? 0 : 1);
+    reqQueue[idx].priority = priority;
     return true;
 }
 
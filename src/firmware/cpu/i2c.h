@@ -36,6 +36,13 @@
 #define I2C_REQ_QUEUE_SIZE 8
 #endif
 
+/** Maximal number of registered devices (individual bus clock, fault
+ * notification and error counters).
+ */
+#ifndef I2C_MAX_DEVICES
+#define I2C_MAX_DEVICES 2
+#endif
+
 #define I2C_REQ_QUEUE_PTR_BITS 4
 #if (1 << I2C_REQ_QUEUE_PTR_BITS) < I2C_REQ_QUEUE_SIZE
 #error I2C_REQ_QUEUE_SIZE is too big. Number of bits in queue pointer should \
@@ -44,6 +51,30 @@
 
 class I2cBus {
 public:
+    /** Bus clock modes. Devices use CLOCK_400K by default. */
+    enum ClockMode {
+        CLOCK_100K,
+        CLOCK_400K,
+        CLOCK_600K,
+        CLOCK_800K,
+        CLOCK_1M,
+
+        NUM_CLOCK_MODES,
+        CLOCK_DEFAULT = CLOCK_400K
+    };
+
+    /** Transfer request priority. Pending request with the highest priority
+     * is started next, requests of the same priority are served in order.
+     * Transfers are not preempted so long transfers should be split.
+     */
+    enum Priority {
+        /** Bulk transfers (e.g. display graphics). */
+        PRIORITY_LOW,
+        PRIORITY_NORMAL,
+        /** Time critical transfers (e.g. RTC, sensors). */
+        PRIORITY_HIGH
+    };
+
     enum TransferStatus {
         /** Do not call the transfer handler. Never seen by the handler. */
         NONE,
@@ -89,6 +120,12 @@ public:
      */
     typedef bool (*TransferHandler)(TransferStatus status, u8 data);
 
+    /** Called after bus fault recovery. Devices state may be lost (e.g. the
+     * transfer was interrupted in the middle of a command) so the device
+     * should be re-initialized.
+     */
+    typedef void (*ResetHandler)();
+
     /** Initialize I2C driver. */
     I2cBus();
 
@@ -108,10 +145,12 @@ public:
      * @param address Target device address. Seven least significant bits are used.
      * @param isTransmit Transmission if true, receiving if false.
      * @param handler Handles the transfer steps.
+     * @param priority Request priority, Priority.
      * @return True if the transfer enqueued, false if failed.
      */
     bool
-    RequestTransfer(u8 address, bool isTransmit, TransferHandler handler);
+    RequestTransfer(u8 address, bool isTransmit, TransferHandler handler,
+                    u8 priority = Priority::PRIORITY_NORMAL);
 
     /** Enqueue new transfer right after the current one. The transfer is guaranteed
      * to be executed with repeated start condition. Should be called in transfer
@@ -121,6 +160,43 @@ public:
     void
     RequestInstantTransfer(u8 address, bool isTransmit, TransferHandler handler);
 
+    /** Register device for bus fault notification and errors accounting.
+     *
+     * @param address Device address. Seven least significant bits are used.
+     * @param resetHandler Handler to call after bus fault recovery.
+     */
+    void
+    RegisterDevice(u8 address, ResetHandler resetHandler);
+
+    /** Set bus clock for transfers with the specified device. The clock is
+     * switched before each transfer start so devices with different clock
+     * limits can share the bus. The device is registered if not yet.
+     *
+     * @param address Device address. Seven least significant bits are used.
+     * @param mode Clock mode, ClockMode.
+     */
+    void
+    SetDeviceClock(u8 address, u8 mode);
+
+    /** Number of failed transfers with the registered device (saturated). */
+    u8
+    GetErrorCount(u8 address);
+
+    /** No transfer is in progress. */
+    bool
+    IsIdle()
+    {
+        adk::AtomicSection as;
+        return state == State::IDLE && IsHwIdle();
+    }
+
+    /** Number of bus fault recoveries performed (saturated). */
+    u8
+    GetRecoveryCount()
+    {
+        return recoveryCount;
+    }
+
     /** Send NACK on next received byte. Should be called in transfer handler
      * only. Have effect in read transfer only.
      */
@@ -186,10 +262,37 @@ private:
         TransferHandler handler;
         /** Address packet byte. */
         u8 sla;
+        /** Priority. */
+        u8 priority;
+    } __PACKED;
+
+    enum {
+        /** Transfer is aborted if no bus events during this number of clock
+         * ticks.
+         */
+        TIMEOUT_TICKS = 3,
+        /** Maximal number of SCL pulses for releasing SDA held by a slave. */
+        BUS_CLEAR_PULSES = 9,
+        /** Half period of SCL pulses when clearing the bus, us. */
+        BUS_CLEAR_DELAY_US = 5
+    };
+
+    /** Registered device. */
+    struct Device {
+        /** Zero for free slot. Device address shifted as in address packet. */
+        u8 sla;
+        /** Bit rate register value. */
+        u8 twbr;
+        u8 errorCount;
+        ResetHandler resetHandler;
     } __PACKED;
 
     /** Pending requests queue. */
     TransferReq reqQueue[I2C_REQ_QUEUE_SIZE];
+    Device devices[I2C_MAX_DEVICES];
+    /** Clock ticks of the last bus activity. */
+    u8 lastActivity;
+    u8 recoveryCount = 0;
     /** Byte to transmit. */
     u8 pendingTransmitByte;
     /** Index of next element in the requests queue. */
@@ -210,10 +313,15 @@ private:
         return (TWCR & _BV(TWINT)) || (TWSR == HwStatus::NO_STATE);
     }
 
-    /** Send START condition. */
+    /** Bit rate register value for the specified clock mode. */
+    static u8
+    GetTwbr(u8 mode);
+
+    /** Send START condition for the transfer at current queue position. */
     inline void
     SendStart()
     {
+        SetClock(reqQueue[queuePtr].sla);
         TWCR = (TWCR & ~(_BV(TWINT) | _BV(TWSTA) | _BV(TWSTO))) |
                (_BV(TWINT) | _BV(TWSTA));
     }
@@ -243,6 +351,60 @@ private:
         nackPending = false;
     }
 
+    /** Set bus clock for the device. Only allowed when no byte transfer is in
+     * progress.
+     */
+    void
+    SetClock(u8 sla);
+
+    /** Find registered device.
+     *
+     * @param sla Address packet byte, direction bit is ignored.
+     * @param alloc Register the device if not found.
+     * @return Device slot, null if not found (or no free slot).
+     */
+    Device *
+    FindDevice(u8 sla, bool alloc = false);
+
+    /** Account failed transfer with the device. */
+    void
+    CountError(u8 sla);
+
+    /** Enable TWI hardware. */
+    void
+    EnableHw();
+
+    /** Abort current transfer, release the bus and re-initialize hardware.
+     * The current and all queued requests are failed, then registered devices
+     * are notified to re-initialize. Should be called with interrupts disabled.
+     */
+    void
+    Recover();
+
+    /** Pulse SCL until slave releases SDA, then generate STOP condition. Lines
+     * are driven by software, TWI should be disabled.
+     */
+    void
+    ClearBus();
+
+    /** Move the pending request with the highest priority to the current
+     * queue position.
+     *
+     * @return True if there is pending request.
+     */
+    bool
+    SelectRequest();
+
+    /** Start transfer at current queue position. Repeated start condition is
+     * sent if the bus is still owned after previous transfer.
+     */
+    void
+    StartTransfer();
+
+    /** Free current request slot and advance the queue. */
+    void
+    ReleaseRequest();
+
     /** Close current trasfer. Should be called with interrupts disabled. */
     void
     CloseTransfer();
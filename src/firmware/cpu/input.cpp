@@ -0,0 +1,113 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file input.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+InputQueue inputQueue;
+
+InputQueue::Event *
+InputQueue::Alloc(u8 type)
+{
+    u8 next = Next(tail);
+    if (next == head) {
+        /* Queue full, drop the event. */
+        return nullptr;
+    }
+    Event *e = &queue[tail];
+    e->type = type;
+    e->delta = 0;
+    e->accelDelta = 0;
+    return e;
+}
+
+void
+InputQueue::PushButton(bool longPress)
+{
+    AtomicSection as;
+    if (Alloc(longPress ? EventType::BUTTON_LONG_PRESSED :
+                         EventType::BUTTON_PRESSED)) {
+        tail = Next(tail);
+        scheduler.SchedulePoll();
+    }
+}
+
+u8
+InputQueue::GetAccelFactor(u8 interval)
+{
+    if (interval >= ACCEL_MAX_INTERVAL) {
+        return 1;
+    }
+    if (interval >= ACCEL_MAX_INTERVAL / 2) {
+        return 2;
+    }
+    if (interval >= ACCEL_MAX_INTERVAL / 4) {
+        return ACCEL_MAX_FACTOR / 2;
+    }
+    return ACCEL_MAX_FACTOR;
+}
+
+void
+InputQueue::PushRotEncClick(bool dir)
+{
+    u8 ticks = clock.GetTicks();
+    i8 accel = GetAccelFactor(ticks - lastClickTicks);
+    lastClickTicks = ticks;
+
+    /* Coalesce with the last pending event unless it is at the head where
+     * the consumer may be reading it.
+     */
+    Event *e;
+    u8 last = tail == 0 ? QUEUE_SIZE - 1 : tail - 1;
+    bool coalesce = tail != head && last != head &&
+        queue[last].type == EventType::ROT_ENC &&
+        queue[last].delta > -127 && queue[last].delta < 127;
+    if (coalesce) {
+        e = &queue[last];
+    } else {
+        e = Alloc(EventType::ROT_ENC);
+        if (!e) {
+            return;
+        }
+    }
+    if (dir) {
+        e->delta++;
+        e->accelDelta += accel;
+    } else {
+        e->delta--;
+        e->accelDelta -= accel;
+    }
+    if (!coalesce) {
+        tail = Next(tail);
+        scheduler.SchedulePoll();
+    }
+}
+
+bool
+InputQueue::Pop(Event &event)
+{
+    if (head == tail) {
+        return false;
+    }
+    event = queue[head];
+    head = Next(head);
+    if (event.type != EventType::ROT_ENC) {
+        return true;
+    }
+    while (head != tail && queue[head].type == EventType::ROT_ENC) {
+        i16 delta = event.delta + queue[head].delta;
+        if (delta < -127 || delta > 127) {
+            break;
+        }
+        event.delta = delta;
+        event.accelDelta += queue[head].accelDelta;
+        head = Next(head);
+    }
+    return true;
+}
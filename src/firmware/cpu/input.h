@@ -0,0 +1,90 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file input.h
+ * User input events queue.
+ */
+
+#ifndef INPUT_H_
+#define INPUT_H_
+
+/** Queue of user input events. Events are produced by the button polling task
+ * and the rotary encoder interrupt, and consumed in the application poll
+ * function. Single producer, single consumer: the producer never modifies the
+ * entry at the queue head so no locking is needed on the producer side.
+ * Consecutive rotary encoder clicks are coalesced into one event.
+ */
+class InputQueue {
+public:
+    enum EventType {
+        NONE,
+        BUTTON_PRESSED,
+        BUTTON_LONG_PRESSED,
+        ROT_ENC
+    };
+
+    struct Event {
+        u8 type;
+        /** Number of rotary encoder clicks, positive for CW direction. */
+        i8 delta;
+        /** Number of clicks with velocity-based acceleration applied. */
+        i16 accelDelta;
+    } __PACKED;
+
+    void
+    PushButton(bool longPress);
+
+    /** Account rotary encoder click. Should be called from interrupt.
+     *
+     * @param dir CW direction when true, CCW when false.
+     */
+    void
+    PushRotEncClick(bool dir);
+
+    /** Get next event. Consecutive rotary encoder events are merged.
+     *
+     * @param event Receives the event.
+     * @return True if event fetched, false if the queue is empty.
+     */
+    bool
+    Pop(Event &event);
+
+private:
+    enum {
+        QUEUE_SIZE = 8,
+        /** Maximal interval between clicks for acceleration, clock ticks. */
+        ACCEL_MAX_INTERVAL = 8,
+        /** Maximal acceleration factor. */
+        ACCEL_MAX_FACTOR = 8
+    };
+
+    Event queue[QUEUE_SIZE];
+    u8 head = 0, tail = 0;
+    /** Clock ticks value of last rotary encoder click. */
+    u8 lastClickTicks = 0;
+
+    /** Prepare new event at the queue tail. The event is committed by
+     * advancing the tail.
+     *
+     * @return Pointer to the event, nullptr if queue is full.
+     */
+    Event *
+    Alloc(u8 type);
+
+    /** Get acceleration factor for the specified interval between clicks. */
+    static u8
+    GetAccelFactor(u8 interval);
+
+    static inline u8
+    Next(u8 idx)
+    {
+        return idx == QUEUE_SIZE - 1 ? 0 : idx + 1;
+    }
+} __PACKED;
+
+extern InputQueue inputQueue;
+
+#endif /* INPUT_H_ */
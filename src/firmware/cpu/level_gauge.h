@@ -71,6 +71,13 @@ public:
     void
     Disable();
 
+    /** Echo timing is in progress. */
+    bool
+    IsMeasuring()
+    {
+        return inProgress;
+    }
+
     void
     Timer1Ovf();
 
@@ -12,26 +12,191 @@ using namespace adk;
 
 Light light;
 
+u16 EEMEM Light::eeTargetIntegral = 600;
+
 void
-Light::OnAdcResult(u8 channel, u16 value)
+Light::CollectSamples()
 {
-    if (channel == AdcChannel::SENSOR_A) {
-        curSensorA = value >> 2;
-    } else if (channel == AdcChannel::SENSOR_B) {
-        curSensorB = value >> 2;
+    Adc::ScanEntry buf[SCAN_READ_CHUNK];
+    u8 n;
+    while ((n = adc.ReadScan(buf, SCAN_READ_CHUNK))) {
+        for (u8 i = 0; i < n; i++) {
+            u8 value = buf[i].value >> 2;
+            if (buf[i].channel == AdcChannel::SENSOR_A) {
+                sumSensorA += value;
+                numSensorA++;
+            } else if (buf[i].channel == AdcChannel::SENSOR_B) {
+                sumSensorB += value;
+                numSensorB++;
+            }
+        }
     }
 }
 
+u16
+Light::ScanReadTask()
+{
+    light.CollectSamples();
+    return SCAN_READ_PERIOD;
+}
+
 void
 Light::Enable()
 {
+    ambientLevel = 0;
+    confirmCount = 0;
+    isAmbientDaylight = false;
+    sensorsDisagree = false;
+    ambientValid = false;
+    manualMode = false;
+    integral = 0;
+    integralDay = rtc.GetDate().day;
+    curSensorA = 0;
+    curSensorB = 0;
+    sumSensorA = 0;
+    sumSensorB = 0;
+    numSensorA = 0;
+    numSensorB = 0;
+    /* Sensors are sampled continuously on each tick and averaged over the
+     * measurement period.
+     */
+    u8 channels[] = {AdcChannel::SENSOR_A, AdcChannel::SENSOR_B};
+    adc.StartScan(channels, SIZEOF_ARRAY(channels));
+    scheduler.ScheduleTask(ScanReadTask, SCAN_READ_PERIOD);
     scheduler.ScheduleTask(PeriodicTask, MEASUREMENT_PERIOD);
 }
 
 u16
 Light::PeriodicTask()
 {
-    adc.ScheduleConversion(AdcChannel::SENSOR_A);
-    adc.ScheduleConversion(AdcChannel::SENSOR_B);
+    if (light.UpdateAmbient()) {
+        flooder.SchedulePoll();
+    }
+    light.Control();
     return MEASUREMENT_PERIOD;
 }
+
+bool
+Light::UpdateAmbient()
+{
+    CollectSamples();
+    if (numSensorA) {
+        curSensorA = sumSensorA / numSensorA;
+    }
+    if (numSensorB) {
+        curSensorB = sumSensorB / numSensorB;
+    }
+    sumSensorA = 0;
+    sumSensorB = 0;
+    numSensorA = 0;
+    numSensorB = 0;
+    u8 a = curSensorA, b = curSensorB;
+    sensorsDisagree = (a > b ? a - b : b - a) >= DISAGREE_LEVEL;
+    /* Shaded or dirty sensor reads lower so trust the brighter one. */
+    u8 sample;
+    if (sensorsDisagree) {
+        sample = a > b ? a : b;
+    } else {
+        sample = (static_cast<u16>(a) + b) / 2;
+    }
+
+    u16 target = static_cast<u16>(sample) << 8;
+    if (!ambientValid) {
+        ambientValid = true;
+        ambientLevel = target;
+        isAmbientDaylight = sample >= DAYLIGHT_ON_LEVEL;
+        return true;
+    }
+    if (target > ambientLevel) {
+        ambientLevel += (target - ambientLevel) >> SMOOTHING_SHIFT;
+    } else {
+        ambientLevel -= (ambientLevel - target) >> SMOOTHING_SHIFT;
+    }
+
+    /* Sensors see the lamp as well, hold the state while it is on. */
+    if (curLevel) {
+        confirmCount = 0;
+        return false;
+    }
+    u8 level = GetAmbientLevel();
+    if (isAmbientDaylight ? level >= DAYLIGHT_OFF_LEVEL :
+                            level < DAYLIGHT_ON_LEVEL) {
+        confirmCount = 0;
+        return false;
+    }
+    confirmCount++;
+    if (confirmCount < CONFIRM_COUNT) {
+        return false;
+    }
+    confirmCount = 0;
+    isAmbientDaylight = !isAmbientDaylight;
+    return true;
+}
+
+u16
+Light::GetTargetIntegral()
+{
+    return eeprom_read_word(&eeTargetIntegral);
+}
+
+void
+Light::SetTargetIntegral(u16 value)
+{
+    eeprom_update_word(&eeTargetIntegral, value);
+    if (value == 0) {
+        /* Control is disabled, do not leave the lamp on. */
+        light.SetLevel(0);
+    }
+}
+
+void
+Light::Control()
+{
+    u8 day = rtc.GetDate().day;
+    if (day != integralDay) {
+        integralDay = day;
+        integral = 0;
+    }
+    integral += GetAmbientLevel();
+
+    u16 targetIntegral = GetTargetIntegral();
+    if (manualMode || targetIntegral == 0) {
+        return;
+    }
+
+    /* Lamp is allowed during the flooder daylight period till the latest
+     * sunset and is driven to the ambient level which meets the target by the
+     * end. The period starts by the detected sunrise or by the end of the
+     * sunrise gate on a dull day, so the lamp never masks the sunrise from
+     * the sensors.
+     */
+    i16 step = -MAX_SLEW;
+    u32 target = static_cast<u32>(targetIntegral) * SAMPLES_PER_HOUR;
+    Time curTime = rtc.GetTime().GetTime();
+    Time endTime = flooder.GetMaxSunsetTime();
+    if (integral < target && flooder.IsDaylight() && curTime < endTime) {
+        u32 samplesLeft = static_cast<u32>((endTime - curTime).TotalMinutes()) *
+            SAMPLES_PER_MINUTE;
+        u32 required = (target - integral + samplesLeft - 1) / samplesLeft;
+        if (required > 0xff) {
+            required = 0xff;
+        }
+        step = (static_cast<i16>(required) - GetAmbientLevel()) >>
+            CONTROL_GAIN_SHIFT;
+        if (step > MAX_SLEW) {
+            step = MAX_SLEW;
+        } else if (step < -MAX_SLEW) {
+            step = -MAX_SLEW;
+        }
+    }
+
+    i16 level = curLevel + step;
+    if (level < 0) {
+        level = 0;
+    } else if (level > 0xff) {
+        level = 0xff;
+    }
+    if (level != curLevel) {
+        SetLevel(level);
+    }
+}
@@ -44,19 +44,129 @@ public:
         return curSensorB;
     }
 
+    /** Ambient light level combined from both sensors and smoothed. */
+    u8
+    GetAmbientLevel()
+    {
+        return ambientLevel >> 8;
+    }
+
+    /** Daylight detected by ambient light sensors. */
+    bool
+    IsAmbientDaylight()
+    {
+        return isAmbientDaylight;
+    }
+
+    /** Sensors readings differ too much, one of them is probably shaded or
+     * faulty.
+     */
+    bool
+    IsSensorsDisagree()
+    {
+        return sensorsDisagree;
+    }
+
+    /** Disable automatic control while the level is set manually. */
     void
-    OnAdcResult(u8 channel, u16 value);
+    SetManualMode(bool f)
+    {
+        manualMode = f;
+    }
+
+    /** Light integral accumulated since midnight, ambient level units
+     * multiplied by hours.
+     */
+    u16
+    GetLightIntegral()
+    {
+        return integral / SAMPLES_PER_HOUR;
+    }
+
+    /** Target daily light integral which is topped up by the lamp. Zero
+     * disables automatic control.
+     */
+    static u16
+    GetTargetIntegral();
+
+    static void
+    SetTargetIntegral(u16 value);
 
 private:
     enum {
-        MEASUREMENT_PERIOD = TASK_DELAY_S(2)
+        MEASUREMENT_PERIOD = TASK_DELAY_S(2),
+        /** Period of collecting sensors samples from the ADC scan buffer. It
+         * should not overflow the buffer since one sample is taken per tick.
+         */
+        SCAN_READ_PERIOD = TASK_DELAY_MS(100),
+        /** Number of scan entries read at once. */
+        SCAN_READ_CHUNK = 4,
+        /** Exponential smoothing factor as power of two. Time constant is
+         * about 32 seconds.
+         */
+        SMOOTHING_SHIFT = 4,
+        /** Ambient level to detect daylight. */
+        DAYLIGHT_ON_LEVEL = 48,
+        /** Ambient level to detect darkness. */
+        DAYLIGHT_OFF_LEVEL = 32,
+        /** Number of consecutive measurements beyond the threshold required
+         * to change the state.
+         */
+        CONFIRM_COUNT = 15,
+        /** Sensors readings difference considered as disagreement. */
+        DISAGREE_LEVEL = 64,
+        SAMPLES_PER_MINUTE = 30,
+        SAMPLES_PER_HOUR = SAMPLES_PER_MINUTE * 60,
+        /** Lamp level change per measurement is ambient level error divided
+         * by this power of two.
+         */
+        CONTROL_GAIN_SHIFT = 1,
+        /** Maximal lamp level change per measurement. */
+        MAX_SLEW = 4
     };
 
     u8 curLevel = 0;
     u8 curSensorA, curSensorB;
+    /** Sums of 8-bit sensors samples collected since the last measurement. */
+    u16 sumSensorA, sumSensorB;
+    u8 numSensorA, numSensorB;
+    /** Smoothed ambient level, 8.8 fixed point. */
+    u16 ambientLevel;
+    u8 confirmCount;
+    u8 isAmbientDaylight:1,
+       sensorsDisagree:1,
+    /** Ambient level is initialized by the first measurement. */
+       ambientValid:1,
+       manualMode:1,
+       :4;
+    /** Ambient level sum since midnight. */
+    u32 integral;
+    /** Day of month the integral is accumulated for. */
+    u8 integralDay:5,
+       :3;
+
+    static u16 EEMEM eeTargetIntegral;
 
     static u16 PeriodicTask();
 
+    static u16
+    ScanReadTask();
+
+    /** Accumulate sensors samples from the ADC scan buffer. */
+    void
+    CollectSamples();
+
+    /** Update ambient level by the last measurement.
+     *
+     * @return True if daylight state changed.
+     */
+    bool
+    UpdateAmbient();
+
+    /** Accumulate daily light integral and adjust the lamp level. */
+    void
+    Control();
+
 } __PACKED;
 
 extern Light light;
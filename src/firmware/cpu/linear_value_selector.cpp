@@ -10,18 +10,33 @@
 
 using namespace adk;
 
+const DrawList::Op LinearValueSelector::drawOps[] PROGMEM = {
+    DrawList::CustomOp(M_TITLE,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawTitle>),
+    DrawList::CustomOp(M_FINE,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawFine>),
+    DrawList::CustomOp(M_HINT,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawHintClear>),
+    DrawList::CustomOp(M_HINT,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawHint>),
+    DrawList::CustomOp(M_GAUGE,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawGauge>),
+    DrawList::CustomOp(M_VALUE,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawValue>),
+    DrawList::CustomOp(M_VALUE,
+        DrawList::Method<LinearValueSelector, &LinearValueSelector::DrawPercents>)
+};
+
 LinearValueSelector::LinearValueSelector(const char *title,
     u16 initialValue, u16 minValue, u16 maxValue, bool readOnly):
+    drawList(this, drawOps, SIZEOF_ARRAY(drawOps)),
     title(title), value(initialValue), minValue(minValue), maxValue(maxValue),
     readOnly(readOnly)
 {
-    drawInProgress = false;
-    drawPending = false;
-    closeRequested = false;
     fineInc = false;
     hintSet = false;
     hintUpdated = false;
-    Draw(true);
+    drawList.Invalidate(DrawMask::M_ALL);
 }
 
 void
@@ -32,7 +47,13 @@ LinearValueSelector::SetValue(u16 value)
         return;
     }
     this->value = value;
-    Draw();
+    drawList.Invalidate(DrawMask::M_GAUGE | DrawMask::M_VALUE);
+}
+
+void
+LinearValueSelector::RefreshValue()
+{
+    drawList.Invalidate(DrawMask::M_VALUE);
 }
 
 void
@@ -46,7 +67,7 @@ LinearValueSelector::SetHint(u16 hintValue)
     hintUpdated = false;
     oldHintValue = this->hintValue;
     this->hintValue = hintValue;
-    Draw(true);
+    drawList.Invalidate(DrawMask::M_HINT | DrawMask::M_VALUE);
 }
 
 void
@@ -58,7 +79,7 @@ LinearValueSelector::UnsetHint()
     }
     hintSet = false;
     hintUpdated = false;
-    Draw(true);
+    drawList.Invalidate(DrawMask::M_HINT | DrawMask::M_VALUE);
 }
 
 void
@@ -106,172 +127,135 @@ LinearValueSelector::OnButtonLongPressed()
         return;
     }
     fineInc = !fineInc;
-    Draw(true);
+    drawList.Invalidate(DrawMask::M_FINE);
 }
 
 void
-LinearValueSelector::OnRotEncClick(bool dir)
+LinearValueSelector::OnRotEnc(i8 delta, i16 accelDelta)
 {
     AtomicSection as;
     if (readOnly) {
         return;
     }
-    bool changed = false;
-    u16 inc = (maxValue - minValue) / 100;
-    if (inc == 0) {
-        inc = 1;
-    }
-    if (dir) {
-        if (value < maxValue) {
-            if (fineInc) {
-                value++;
-            } else if (maxValue - value > inc) {
-                value += inc;
-            } else {
-                value = maxValue;
-            }
-            changed = true;
-        }
-    } else if (value > minValue) {
-        if (fineInc) {
-            value--;
-        } else if (value - minValue > inc) {
-            value -= inc;
-        } else {
-            value = minValue;
+    /* Fine mode steps by exactly one per click, no acceleration. */
+    i32 step;
+    if (fineInc) {
+        step = delta;
+    } else {
+        u16 inc = (maxValue - minValue) / 100;
+        if (inc == 0) {
+            inc = 1;
         }
-        changed = true;
+        step = static_cast<i32>(inc) * accelDelta;
+    }
+    i32 newValue = static_cast<i32>(value) + step;
+    if (newValue > maxValue) {
+        newValue = maxValue;
+    } else if (newValue < minValue) {
+        newValue = minValue;
     }
-    if (changed) {
+    if (newValue != value) {
+        value = newValue;
         OnChanged(value);
+        drawList.Invalidate(DrawMask::M_GAUGE | DrawMask::M_VALUE);
     }
-    Draw();
+}
+
+bool
+LinearValueSelector::RequestClose()
+{
+    return drawList.Close();
 }
 
 void
-LinearValueSelector::Poll()
+LinearValueSelector::OnDisplayReset()
 {
-    Page::Poll();
     AtomicSection as;
-    if (drawPending && !drawInProgress) {
-        drawPending = false;
-        Draw(fullDrawPending);
-    }
+    hintUpdated = false;
+    drawList.Invalidate(DrawMask::M_ALL);
 }
 
-bool
-LinearValueSelector::RequestClose()
+u8
+LinearValueSelector::DrawTitle()
 {
-    AtomicSection as;
-    closeRequested = true;
-    return !drawInProgress;
+    textWriter.Write(Display::Viewport{0, 127, 0, 1}, title, false, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
 }
 
-void
-LinearValueSelector::Draw(bool full)
+u8
+LinearValueSelector::DrawFine()
 {
-    AtomicSection as;
-    if (closeRequested) {
-        return;
-    }
-    if (drawInProgress) {
-        drawPending = true;
-        fullDrawPending = full;
-        return;
+    if (fineInc) {
+        textWriter.Write(Display::Viewport{0, 127, 7, 7}, strings.Fine,
+                         true, false, DrawList::_DoneHandler);
+    } else {
+        textWriter.Clear(Display::Viewport{0, 127, 7, 7}, strings.Fine,
+                         false, false, DrawList::_DoneHandler);
     }
-    drawInProgress = true;
-    drawState = full ? DrawState::FULL_DRAW : DrawState::PARTIAL_DRAW;
-    gaugeLen = GetGaugeLen(value);
-    IssueDrawRequest();
+    return DrawList::Result::CONTINUE;
 }
 
-void
-LinearValueSelector::IssueDrawRequest()
+u8
+LinearValueSelector::DrawHintClear()
 {
-    switch (drawState) {
-    case DrawState::TITLE:
-        textWriter.Write(Display::Viewport{0, 127, 0, 1}, title, false, false,
-                         _DrawHandler);
-        break;
-    case DrawState::FINE:
-        if (fineInc) {
-            textWriter.Write(Display::Viewport{0, 127, 7, 7}, strings.Fine,
-                             true, false, _DrawHandler);
-        } else {
-            textWriter.Clear(Display::Viewport{0, 127, 7, 7}, strings.Fine,
-                             false, false, _DrawHandler);
-        }
-        break;
-    case DrawState::HINT_CLEAR:
-        if (!hintUpdated && hintSet) {
-            bitmapWriter.Clear(GetGaugeLen(oldHintValue), 5,
-                               &bitmaps.LinearValueSelectorHint,
-                               false, _DrawHandler);
-            oldHintValue = hintValue;
-            break;
-        }
-        drawState = DrawState::HINT;
-        /* FALL THROUGH */
-    case DrawState::HINT:
-        if (!hintUpdated) {
-            u8 col = GetGaugeLen(hintValue);
-            if (hintSet) {
-                bitmapWriter.Write(col, 5, &bitmaps.LinearValueSelectorHint,
-                                   false, _DrawHandler);
-            } else {
-                bitmapWriter.Clear(col, 5, &bitmaps.LinearValueSelectorHint,
-                                   false, _DrawHandler);
-            }
-            hintUpdated = true;
-            break;
-        }
-        drawState = DrawState::GAUGE;
-        /* FALL THROUGH */
-    case DrawState::GAUGE:
-        display.Output(Display::Viewport{0, 127, 4, 4}, _GaugeDrawHandler);
-        break;
-    case DrawState::VALUE:
-        Print(value, buf);
-        textWriter.Write(Display::Viewport{0, 127, 2, 3}, buf,
-                         false, true, _DrawHandler);
-        break;
-    case DrawState::PERCENTS:
-        u8 prc = static_cast<u32>(value - minValue) * 100 /
-            (maxValue - minValue);
-        utoa(prc, buf, 10);
-        u8 len = strlen(buf);
-        buf[len] = '%';
-        buf[len + 1] = 0;
-        textWriter.Write(Display::Viewport{56, 88, 6, 6}, buf,
-                         false, true, _DrawHandler);
-        break;
+    if (hintUpdated || !hintSet) {
+        return DrawList::Result::SKIP;
     }
+    bitmapWriter.Clear(GetGaugeLen(oldHintValue), 5,
+                       &bitmaps.LinearValueSelectorHint,
+                       false, DrawList::_DoneHandler);
+    oldHintValue = hintValue;
+    return DrawList::Result::CONTINUE;
 }
 
-void
-LinearValueSelector::DrawHandler()
+u8
+LinearValueSelector::DrawHint()
 {
-    AtomicSection as;
-
-    if (closeRequested ||
-        (drawPending && (fullDrawPending || drawState >= DrawState::PARTIAL_DRAW))) {
-
-        drawInProgress = false;
-        return;
+    if (hintUpdated) {
+        return DrawList::Result::SKIP;
     }
-
-    if (drawState != DrawState::LAST) {
-        drawState++;
-        IssueDrawRequest();
-        return;
+    u8 col = GetGaugeLen(hintValue);
+    if (hintSet) {
+        bitmapWriter.Write(col, 5, &bitmaps.LinearValueSelectorHint,
+                           false, DrawList::_DoneHandler);
+    } else {
+        bitmapWriter.Clear(col, 5, &bitmaps.LinearValueSelectorHint,
+                           false, DrawList::_DoneHandler);
     }
-    drawInProgress = false;
+    hintUpdated = true;
+    return DrawList::Result::CONTINUE;
 }
 
-void
-LinearValueSelector::_DrawHandler()
+u8
+LinearValueSelector::DrawGauge()
+{
+    gaugeLen = GetGaugeLen(value);
+    display.Output(Display::Viewport{0, 127, 4, 4}, _GaugeDrawHandler);
+    return DrawList::Result::CONTINUE;
+}
+
+u8
+LinearValueSelector::DrawValue()
+{
+    Print(value, buf);
+    textWriter.Write(Display::Viewport{0, 127, 2, 3}, buf,
+                     false, true, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
+}
+
+u8
+LinearValueSelector::DrawPercents()
 {
-    static_cast<LinearValueSelector *>(app.CurPage())->DrawHandler();
+    u8 prc = static_cast<u32>(value - minValue) * 100 /
+        (maxValue - minValue);
+    utoa(prc, buf, 10);
+    u8 len = strlen(buf);
+    buf[len] = '%';
+    buf[len + 1] = 0;
+    textWriter.Write(Display::Viewport{56, 88, 6, 6}, buf,
+                     false, true, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
 }
 
 bool
@@ -292,7 +276,7 @@ LinearValueSelector::GaugeDrawHandler(u8 column, u8 page __UNUSED, u8 *data)
     }
     *data = px;
     if (column == 127) {
-        DrawHandler();
+        drawList.DoneHandler();
     }
     return true;
 }
@@ -44,6 +44,12 @@ public:
     void
     SetValue(u16 value);
 
+    /** Redraw the value text, e.g. when the printer output depends on other
+     * data.
+     */
+    void
+    RefreshValue();
+
     /** Set hint value to display under the gauge. */
     void
     SetHint(u16 hintValue);
@@ -69,59 +75,62 @@ public:
     OnButtonLongPressed() override;
 
     virtual void
-    OnRotEncClick(bool dir) override;
-
-    virtual void
-    Poll() override;
+    OnRotEnc(i8 delta, i16 accelDelta) override;
 
     virtual bool
     RequestClose() override;
 
+    virtual void
+    OnDisplayReset() override;
+
 private:
-    enum DrawState {
-        FULL_DRAW,
-        TITLE = FULL_DRAW,
-        FINE,
-        HINT_CLEAR,
-        HINT,
-
-        PARTIAL_DRAW,
-        GAUGE = PARTIAL_DRAW,
-        VALUE,
-        PERCENTS,
-
-        LAST = PERCENTS
+    enum DrawMask {
+        M_TITLE =   0x01,
+        M_FINE =    0x02,
+        M_HINT =    0x04,
+        M_GAUGE =   0x08,
+        M_VALUE =   0x10,
+
+        M_ALL = M_TITLE | M_FINE | M_HINT | M_GAUGE | M_VALUE
     };
+
+    static const DrawList::Op drawOps[] PROGMEM;
+    DrawList drawList;
+
     const char *title;
     u16 value, minValue, maxValue, hintValue, oldHintValue;
     char buf[PRINTER_BUF_SIZE];
 
-    u8 drawInProgress:1,
-       drawPending:1,
-       fullDrawPending:1,
-       closeRequested:1,
-       drawState:3,
-       fineInc:1,
+    u8 fineInc:1,
+       reserved:7,
 
        gaugeLen:7,
        readOnly:1,
 
        hintSet:1,
        hintUpdated:1,
-       reserved:7;
+       reserved2:6;
 
-    void
-    Draw(bool full = false);
+    u8
+    DrawTitle();
 
-    /** Issue draw request depending on current draw state. */
-    void
-    IssueDrawRequest();
+    u8
+    DrawFine();
 
-    void
-    DrawHandler();
+    u8
+    DrawHintClear();
+
+    u8
+    DrawHint();
+
+    u8
+    DrawGauge();
+
+    u8
+    DrawValue();
 
-    static void
-    _DrawHandler();
+    u8
+    DrawPercents();
 
     bool
     GaugeDrawHandler(u8 column, u8 page, u8 *data);
@@ -29,56 +29,6 @@ Clock::Clock()
     TIMSK0 = _BV(TOIE0);
 }
 
-/* ****************************************************************************/
-/* Temperature measurement. */
-
-static struct {
-    /** Accumulated samples since last launch. */
-    u16 accumulated;
-    /** Calibration offset for 0 C. */
-    u16 calOffset:10,
-        pending:1,
-        :5,
-        curTempRaw;
-    /** Calibration factor. 0x80 is 1.0, 0xff is 1.996 */
-    u8 calFactor;
-    u8 curTemp;
-} g_temp;
-
-static inline void
-TempInit()
-{
-    //XXX
-//    g_temp.calOffset = eeprom_read_word(&e_tempCalOffset);
-//    g_temp.calFactor = eeprom_read_byte(&e_tempCalFactor);
-}
-
-static inline void
-TempFeedValue(u16 value)
-{
-    if (!g_temp.pending) {
-        return;
-    }
-    g_temp.pending = 0;
-
-    g_temp.curTempRaw = value;
-    i32 temp = value - g_temp.calOffset;
-    /* Celsius * 2. */
-    temp = ((temp * g_temp.calFactor) >> 6) + 100;
-    /* Base is -50C */
-    g_temp.curTemp = temp;
-
-    i16 delta = (temp - 100) / 2;
-    if (delta < 0) {
-        return;
-    }
-    if ((u32)g_temp.accumulated + delta >= 0xffff) {
-        g_temp.accumulated = 0xffff;
-    } else {
-        g_temp.accumulated += delta;
-    }
-}
-
 /* ****************************************************************************/
 /* Button control. */
 
@@ -93,7 +43,7 @@ BtnPoll()
     /* Active is pull to ground. */
     if (AVR_BIT_GET8(AVR_REG_PIN(BUTTON_PORT), BUTTON_PIN)) {
         if (pressCnt >= BTN_JITTER_DELAY && pressCnt < BTN_LONG_DELAY) {
-            app.OnButtonPressed();
+            inputQueue.PushButton(false);
         }
         pressCnt = 0;
         return 1;
@@ -103,7 +53,7 @@ BtnPoll()
     }
     pressCnt++;
     if (pressCnt == BTN_LONG_DELAY) {
-        app.OnButtonLongPressed();
+        inputQueue.PushButton(true);
     }
     return 1;
 }
@@ -225,7 +175,7 @@ private:
             }
             stepCount = 0;
             if (dir != 0) {
-                app.OnRotEncClick(dir > 0);
+                inputQueue.PushRotEncClick(dir > 0);
             }
         }
     }
@@ -279,6 +229,7 @@ ISR(TIMER0_COMPB_vect)
 ISR(PCINT2_vect)
 {
     rotEnc.HandlePinChangeInterrupt();
+    rtc.HandlePinChangeInterrupt();
 }
 
 /* ****************************************************************************/
@@ -286,6 +237,9 @@ ISR(PCINT2_vect)
 
 static u8 pwm3Value;
 
+/* Runs at ~39kHz and never enables interrupts to keep it as short as
+ * possible.
+ */
 ISR(TIMER2_OVF_vect)
 {
 
@@ -414,6 +368,30 @@ SleepEnabled()
     return adc.SleepEnabled();
 }
 
+const Adc::ResultHandler adcHandlers[Adc::NUM_CHANNELS] PROGMEM = {
+    /* 0 - Light::SENSOR_A, scanned */ nullptr,
+    /* 1 - Light::SENSOR_B, scanned */ nullptr,
+    /* 2 - Nutrients::EC_SENSOR */ Nutrients::_OnAdcResult,
+    /* 3 - Nutrients::PH_SENSOR */ Nutrients::_OnAdcResult,
+    /* 4 */ nullptr,
+    /* 5 */ nullptr,
+    /* 6 */ nullptr,
+    /* 7 */ nullptr,
+    /* 8 - internal temperature sensor */ nullptr
+};
+
+const Adc::StartHandler adcStartHandlers[Adc::NUM_CHANNELS] PROGMEM = {
+    /* 0 - Light::SENSOR_A */ nullptr,
+    /* 1 - Light::SENSOR_B */ nullptr,
+    /* 2 - Nutrients::EC_SENSOR */ Nutrients::_OnAdcStart,
+    /* 3 - Nutrients::PH_SENSOR */ nullptr,
+    /* 4 */ nullptr,
+    /* 5 */ nullptr,
+    /* 6 */ nullptr,
+    /* 7 */ nullptr,
+    /* 8 - internal temperature sensor */ nullptr
+};
+
 void
 adk::PollFunc()
 {
@@ -434,12 +412,15 @@ main(void)
     PwmInit();
 
     led.Initialize();
+    sysMonitor.Initialize();
     rtc.Initialize();
     sound.Initialize();
     display.Initialize();
     display.Clear();
     lvlGauge.Enable();
     light.Enable();
+    tempMonitor.Enable();
+    nutrients.Enable();
     flooder.Initialize();
     app.Initialize();
 
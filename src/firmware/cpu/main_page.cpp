@@ -16,10 +16,52 @@ MainPage::Fabric(void *p)
     new (p) MainPage();
 }
 
-MainPage::MainPage()
+const DrawList::Op MainPage::drawOps[] PROGMEM = {
+    DrawList::BitmapOp(M_STATIC, &bitmaps.PotWall, POT_COL, POT_PAGE),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.PotWall, POT_COL + 23, POT_PAGE),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.SiphonTop, POT_COL + 16, POT_PAGE),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.SiphonBottom,
+        POT_COL + 16, POT_PAGE + 2),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.SiphonWall,
+        POT_COL + 16, POT_PAGE + 1),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.PumpPipeTop,
+        POT_COL - 5, POT_PAGE + 2),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.PumpPipeBottom,
+        POT_COL - 5, POT_PAGE + 4),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.Sun, 0, 2),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.Sunset, 9 + 5 * (FONT_WIDTH + 1), 2),
+    DrawList::BitmapOp(M_STATIC, &bitmaps.Thermometer, 0, 1),
+
+    DrawList::CustomOp(M_PUMP, DrawList::Method<MainPage, &MainPage::DrawPump>),
+    DrawList::CustomOp(M_DRAIN,
+        DrawList::Method<MainPage, &MainPage::DrawDrain>),
+    DrawList::CustomOp(M_TOP_WATER,
+        DrawList::Method<MainPage, &MainPage::DrawTopWater>),
+    DrawList::CustomOp(M_BOTTOM_WATER,
+        DrawList::Method<MainPage, &MainPage::DrawBottomWater>),
+    DrawList::CustomOp(M_STATUS,
+        DrawList::Method<MainPage, &MainPage::DrawStatus>),
+    DrawList::CustomOp(M_DAYLIGHT,
+        DrawList::Method<MainPage, &MainPage::DrawDaylight>),
+    DrawList::CustomOp(M_CLOCK,
+        DrawList::Method<MainPage, &MainPage::DrawClock>),
+    DrawList::CustomOp(M_WATER_PERCENT,
+        DrawList::Method<MainPage, &MainPage::DrawWaterPercent>),
+    DrawList::CustomOp(M_SUNRISE,
+        DrawList::Method<MainPage, &MainPage::DrawSunrise>),
+    DrawList::CustomOp(M_SUNSET,
+        DrawList::Method<MainPage, &MainPage::DrawSunset>),
+    DrawList::CustomOp(M_TEMPERATURE,
+        DrawList::Method<MainPage, &MainPage::DrawTemperature>),
+    DrawList::CustomOp(M_FLOOD_TIME,
+        DrawList::Method<MainPage, &MainPage::DrawFloodTime>)
+};
+
+MainPage::MainPage():
+    drawList(this, drawOps, SIZEOF_ARRAY(drawOps)),
+    floodTimeField(128 - (FONT_WIDTH + 1) * 5, 0, 5),
+    temperatureField(7, 1, 8, POT_COL - 2)
 {
-    drawMask = DrawMask::M_ALL;
-    drawInProgress = false;
     closeRequested = false;
     pumpActive = false;
     drainActive = false;
@@ -33,6 +75,7 @@ MainPage::MainPage()
     watLevelBottom = MAX_WATER_LEVEL;
     watLevelTop = 0;
 
+    drawList.Invalidate(DrawMask::M_ALL);
     SetStatus(flooder.GetStatusString());
 }
 
@@ -44,21 +87,11 @@ MainPage::OnButtonPressed()
 }
 
 void
-MainPage::OnRotEncClick(bool dir __UNUSED/*XXX*/)
+MainPage::OnRotEnc(i8 delta __UNUSED/*XXX*/, i16 accelDelta __UNUSED)
 {
     //XXX
 }
 
-void
-MainPage::Poll()
-{
-    Page::Poll();
-    AtomicSection as;
-    if (!drawInProgress && drawMask) {
-        Draw(drawMask);
-    }
-}
-
 bool
 MainPage::RequestClose()
 {
@@ -66,270 +99,178 @@ MainPage::RequestClose()
     if (!closeRequested) {
         closeRequested = true;
         scheduler.UnscheduleTask(_AnimationTask);
+        display.StopScroll();
     }
-    return !drawInProgress;
+    return drawList.Close();
 }
 
 void
-MainPage::Draw(u16 mask)
+MainPage::OnDisplayReset()
 {
     AtomicSection as;
-    if (closeRequested) {
-        return;
-    }
-    drawMask |= mask;
-    if (drawInProgress) {
-        return;
+    shownClock = 0xffff;
+    floodTimeField.Invalidate();
+    temperatureField.Invalidate();
+    drawList.Invalidate(DrawMask::M_ALL);
+}
+
+u8
+MainPage::DrawPump()
+{
+    bitmapWriter.Write(POT_COL - 8, POT_PAGE + 3,
+                       pumpActive ? &bitmaps.PumpActive : &bitmaps.PumpInactive,
+                       false, DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
+}
+
+u8
+MainPage::DrawDrain()
+{
+    if (drainActive) {
+        bitmapWriter.Write(POT_COL + 17, POT_PAGE + 1,
+                           &bitmaps.SyphonDrain, false, DrawList::_DoneHandler);
+    } else {
+        bitmapWriter.Clear(POT_COL + 17, POT_PAGE + 1,
+                           &bitmaps.SyphonDrain, false, DrawList::_DoneHandler);
     }
-    drawInProgress = true;
-    drawState = 0;
-    IssueDrawRequest();
+    return DrawList::Result::CONTINUE;
 }
 
-void
-MainPage::IssueDrawRequest()
+u8
+MainPage::DrawTopWater()
 {
-    do {
-        switch (drawState) {
+    display.Output(Display::Viewport{POT_COL + 1, POT_COL + 15,
+                                     POT_PAGE, POT_PAGE + 2},
+                   _DisplayOutputHandler);
+    return DrawList::Result::CONTINUE;
+}
 
-        case DrawState::POT_WALLS_1:
-            if (!(drawMask & DrawMask::M_STATIC)) {
-                drawState = DrawState::PUMP;
-                break;
-            }
-            drawMask &= ~DrawMask::M_STATIC;
-            bitmapWriter.Write(POT_COL, POT_PAGE, &bitmaps.PotWall, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_2:
-            bitmapWriter.Write(POT_COL + 23, POT_PAGE, &bitmaps.PotWall, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_3:
-            bitmapWriter.Write(POT_COL + 16, POT_PAGE, &bitmaps.SiphonTop, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_4:
-            bitmapWriter.Write(POT_COL + 16, POT_PAGE + 2,
-                               &bitmaps.SiphonBottom, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_5:
-            bitmapWriter.Write(POT_COL + 16, POT_PAGE + 1,
-                               &bitmaps.SiphonWall, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_PUMP1:
-            bitmapWriter.Write(POT_COL - 5, POT_PAGE + 2,
-                               &bitmaps.PumpPipeTop, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::POT_WALLS_PUMP2:
-            bitmapWriter.Write(POT_COL - 5, POT_PAGE + 4,
-                               &bitmaps.PumpPipeBottom, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::SUNRISE_ICON:
-            bitmapWriter.Write(0, 2, &bitmaps.Sun, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::SUNSET_ICON:
-            bitmapWriter.Write(9 + 5 * (FONT_WIDTH + 1), 2, &bitmaps.Sunset,
-                               false, _DrawHandler);
-            return;
-
-        case DrawState::TEMP_ICON:
-            bitmapWriter.Write(0, 1, &bitmaps.Thermometer, false,
-                               _DrawHandler);
-            return;
-
-        case DrawState::PUMP:
-            if (!(drawMask & DrawMask::M_PUMP)) {
-                drawState = DrawState::DRAIN;
-                break;
-            }
-            drawMask &= ~DrawMask::M_PUMP;
-            bitmapWriter.Write(POT_COL - 8, POT_PAGE + 3,
-                               pumpActive ? &bitmaps.PumpActive : &bitmaps.PumpInactive,
-                               false, _DrawHandler);
-            return;
-
-        case DrawState::DRAIN:
-            if (!(drawMask & DrawMask::M_DRAIN)) {
-                drawState = DrawState::TOP_WATER;
-                break;
-            }
-            drawMask &= ~DrawMask::M_DRAIN;
-            if (drainActive) {
-                bitmapWriter.Write(POT_COL + 17, POT_PAGE + 1,
-                                   &bitmaps.SyphonDrain, false, _DrawHandler);
-            } else {
-                bitmapWriter.Clear(POT_COL + 17, POT_PAGE + 1,
-                                   &bitmaps.SyphonDrain, false, _DrawHandler);
-            }
-            return;
+u8
+MainPage::DrawBottomWater()
+{
+    display.Output(Display::Viewport{POT_COL + 1, POT_COL + 22,
+                                     POT_PAGE + 3, POT_PAGE + 5},
+                   _DisplayOutputHandler);
+    return DrawList::Result::CONTINUE;
+}
 
-        case DrawState::TOP_WATER:
-            if (!(drawMask & DrawMask::M_TOP_WATER)) {
-                drawState = DrawState::BOTTOM_WATER;
-                break;
-            }
-            drawMask &= ~DrawMask::M_TOP_WATER;
-            display.Output(Display::Viewport{POT_COL + 1, POT_COL + 15,
-                                             POT_PAGE, POT_PAGE + 2},
-                           _DisplayOutputHandler);
-            return;
-
-        case DrawState::BOTTOM_WATER:
-            if (!(drawMask & DrawMask::M_BOTTOM_WATER)) {
-                drawState = DrawState::STATUS;
-                break;
-            }
-            drawMask &= ~DrawMask::M_BOTTOM_WATER;
-            display.Output(Display::Viewport{POT_COL + 1, POT_COL + 22,
-                                             POT_PAGE + 3, POT_PAGE + 5},
-                           _DisplayOutputHandler);
-            return;
-
-        case DrawState::STATUS:
-            if (!(drawMask & DrawMask::M_STATUS)) {
-                drawState = DrawState::DAYLIGHT;
-                break;
-            }
-            drawMask &= ~DrawMask::M_STATUS;
-            if (!status) {
-                display.Clear(Display::Viewport{0, 127, 7, 7});
-                drawState = DrawState::DAYLIGHT;
-                break;
-            }
-            if (isStatusPgm) {
-                textWriter.Write(Display::Viewport{0, 127, 7, 7},
-                                 status + statusOffset, false,
-                                 true, _DrawHandler);
-            } else {
-                textWriter.Write(Display::Viewport{0, 127, 7, 7},
-                                 const_cast<char *>(status) + statusOffset, false,
-                                 true, _DrawHandler);
-            }
-            return;
-
-        case DrawState::DAYLIGHT:
-            if (!(drawMask & DrawMask::M_DAYLIGHT)) {
-               drawState = DrawState::CLOCK;
-               break;
-           }
-           drawMask &= ~DrawMask::M_DAYLIGHT;
-           bitmapWriter.Write(0, 0, flooder.IsAmbientDaylight() ? &bitmaps.Sun :
-                                                                  &bitmaps.Moon,
-                              false, _DrawHandler);
-           return;
-
-        case DrawState::CLOCK:
-            if (!(drawMask & DrawMask::M_CLOCK)) {
-                drawState = DrawState::SUNRISE;
-                break;
-            }
-            drawMask &= ~DrawMask::M_CLOCK;
-            GetClockText();
-            textWriter.Write(Display::Viewport{12, 12 + (FONT_WIDTH + 1) * 8 - 1, 0, 0},
-                             textBuf, false, true, _DrawHandler);
-            return;
-
-        case DrawState::SUNRISE:
-            if (!(drawMask & DrawMask::M_SUNRISE)) {
-                drawState = DrawState::SUNSET;
-                break;
-            }
-            drawMask &= ~DrawMask::M_SUNRISE;
-            GetTimeText(flooder.GetLastSunriseTime());
-            textWriter.Write(Display::Viewport{9, 9 + 5 * (FONT_WIDTH + 1) - 1,
-                                               2, 2},
-                             textBuf, false, true, _DrawHandler);
-            return;
-
-        case DrawState::SUNSET: {
-            if (!(drawMask & DrawMask::M_SUNSET)) {
-                drawState = DrawState::TEMPERATURE;
-                break;
-            }
-            drawMask &= ~DrawMask::M_SUNSET;
-            GetTimeText(flooder.GetLastSunsetTime());
-            u8 x1 = 9 + 5 * (FONT_WIDTH + 1) + 9;
-            u8 x2 = x1 + 5 * (FONT_WIDTH + 1) - 1;
-            textWriter.Write(Display::Viewport{x1, x2, 2, 2},
-                             textBuf, false, true, _DrawHandler);
-            return;
-        }
+u8
+MainPage::DrawStatus()
+{
+    if (!status) {
+        display.Clear(Display::Viewport{0, 127, 7, 7});
+        return DrawList::Result::SKIP;
+    }
+    Display::Viewport vp;
+    if (statusLen > STATUS_LINE_CHARS) {
+        /* Gap between chunk end and start in the rotated line. */
+        display.Clear(Display::Viewport{STATUS_CHUNK_COLS, 127, 7, 7});
+        vp = Display::Viewport{0, STATUS_CHUNK_COLS - 1, 7, 7};
+    } else {
+        vp = Display::Viewport{0, 127, 7, 7};
+    }
+    if (isStatusPgm) {
+        textWriter.Write(vp, status + statusOffset, false,
+                         true, DrawList::_DoneHandler);
+    } else {
+        textWriter.Write(vp, const_cast<char *>(status) + statusOffset,
+                         false, true, DrawList::_DoneHandler);
+    }
+    /* Status strings are constant. */
+    return DrawList::Result::CONTINUE;
+}
 
-        case DrawState::TEMPERATURE:
-            if (!(drawMask & DrawMask::M_TEMPERATURE)) {
-                drawState = DrawState::FLOOD_TIME;
-                break;
-            }
-            drawMask &= ~DrawMask::M_TEMPERATURE;
-            GetTemperatureText();
-            textWriter.Write(Display::Viewport{7, POT_COL - 2, 1, 1},
-                             textBuf, false, true, _DrawHandler);
-            return;
+u8
+MainPage::DrawDaylight()
+{
+    bitmapWriter.Write(0, 0, flooder.IsAmbientDaylight() ? &bitmaps.Sun :
+                                                           &bitmaps.Moon,
+                       false, DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
+}
 
+u8
+MainPage::DrawClock()
+{
+    Time t = rtc.GetTime().GetTime();
+    u16 clock = static_cast<u16>(t.hour) * 60 + t.min;
+    if (clock == shownClock) {
+        /* Redraw only when minute changes. */
+        return DrawList::Result::SKIP;
+    }
+    shownClock = clock;
+    GetTimeText(t);
+    textWriter.Write(Display::Viewport{0, LARGE_FIELD_COLS - 1,
+                                       CLOCK_PAGE, CLOCK_PAGE + 1},
+                     textBuf, TextWriter::FontId::FONT_LARGE, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
+}
 
-        case DrawState::FLOOD_TIME: {
-            if (!(drawMask & DrawMask::M_FLOOD_TIME)) {
-                drawState = DrawState::DONE;
-                break;
-            }
-            drawMask &= ~DrawMask::M_FLOOD_TIME;
-            Time t = flooder.GetNextFloodTime();
-            if (t) {
-                GetTimeText(t - rtc.GetTime().GetTime());
-            } else {
-                textBuf[0] = '-';
-                textBuf[1] = '-';
-                textBuf[2] = ':';
-                textBuf[3] = '-';
-                textBuf[4] = '-';
-                textBuf[5] = 0;
-            }
-            textWriter.Write(Display::Viewport{128 - (FONT_WIDTH + 1) * 5, 127, 0, 0},
-                             textBuf, false, true, _DrawHandler);
-            return;
-        }
-        default:
-            break;
-        }
-    } while (drawMask && drawState < DrawState::DONE);
-    drawInProgress = false;
+u8
+MainPage::DrawWaterPercent()
+{
+    itoa(waterPercent, textBuf, 10);
+    u8 len = strlen(textBuf);
+    textBuf[len] = '%';
+    textBuf[len + 1] = 0;
+    textWriter.Write(Display::Viewport{0, LARGE_FIELD_COLS - 1,
+                                       WATER_PERCENT_PAGE,
+                                       WATER_PERCENT_PAGE + 1},
+                     textBuf, TextWriter::FontId::FONT_LARGE, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
 }
 
-void
-MainPage::DrawHandler()
+u8
+MainPage::DrawSunrise()
 {
-    AtomicSection as;
+    GetTimeText(flooder.GetLastSunriseTime());
+    textWriter.Write(Display::Viewport{9, 9 + 5 * (FONT_WIDTH + 1) - 1, 2, 2},
+                     textBuf, false, true, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
+}
 
-    if (closeRequested) {
-        drawInProgress = false;
-        return;
-    }
-    drawState++;
-    if (drawState != DrawState::DONE) {
-        IssueDrawRequest();
-        return;
+u8
+MainPage::DrawSunset()
+{
+    GetTimeText(flooder.GetLastSunsetTime());
+    u8 x1 = 9 + 5 * (FONT_WIDTH + 1) + 9;
+    u8 x2 = x1 + 5 * (FONT_WIDTH + 1) - 1;
+    textWriter.Write(Display::Viewport{x1, x2, 2, 2},
+                     textBuf, false, true, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
+}
+
+u8
+MainPage::DrawTemperature()
+{
+    GetTemperatureText();
+    /* Text is copied to the field. */
+    if (!temperatureField.Write(textBuf, false, DrawList::_DoneHandler)) {
+        return DrawList::Result::SKIP;
     }
-    drawInProgress = false;
+    return DrawList::Result::CONTINUE;
 }
 
-void
-MainPage::_DrawHandler()
+u8
+MainPage::DrawFloodTime()
 {
-    return static_cast<MainPage *>(app.CurPage())->DrawHandler();
+    Time t = flooder.GetNextFloodTime();
+    if (t) {
+        GetTimeText(t - rtc.GetTime().GetTime());
+    } else {
+        textBuf[0] = '-';
+        textBuf[1] = '-';
+        textBuf[2] = ':';
+        textBuf[3] = '-';
+        textBuf[4] = '-';
+        textBuf[5] = 0;
+    }
+    if (!floodTimeField.Write(textBuf, false, DrawList::_DoneHandler)) {
+        return DrawList::Result::SKIP;
+    }
+    return DrawList::Result::CONTINUE;
 }
 
 /** Get byte which has numBits most significant bits set. */
@@ -348,7 +289,8 @@ bool
 MainPage::DisplayOutputHandler(u8 column, u8 page, u8 *data)
 {
     u8 _data = 0;
-    if (drawState == DrawState::TOP_WATER) {
+    if (page <= POT_PAGE + 2) {
+        /* Top pot. */
 
         if (page == POT_PAGE) {
             _data = 0b00000001;
@@ -372,10 +314,11 @@ MainPage::DisplayOutputHandler(u8 column, u8 page, u8 *data)
         }
 
         if (column == POT_COL + 15 && page == POT_PAGE + 2) {
-            DrawHandler();
+            drawList.DoneHandler();
         }
 
-    } else if (drawState == DrawState::BOTTOM_WATER) {
+    } else {
+        /* Bottom tank. */
 
         if (page == POT_PAGE + 3) {
             if (watLevelBottom > 15) {
@@ -400,7 +343,7 @@ MainPage::DisplayOutputHandler(u8 column, u8 page, u8 *data)
         }
 
         if (column == POT_COL + 22 && page == POT_PAGE + 5) {
-            DrawHandler();
+            drawList.DoneHandler();
         }
     }
     *data = _data;
@@ -421,7 +364,7 @@ MainPage::SetStatus(const char *status, bool isPgm)
     this->status = status;
     isStatusPgm = isPgm;
     statusOffset = 0;
-    statusScrollDir = false;
+    statusChunkPeriods = 0;
     if (status) {
         if (isPgm) {
             statusLen = strlen_P(status);
@@ -431,7 +374,23 @@ MainPage::SetStatus(const char *status, bool isPgm)
     } else {
         statusLen = 0;
     }
-    Draw(DrawMask::M_STATUS);
+    /* Long text is scrolled by the display controller, no traffic needed for
+     * each step.
+     */
+    if (statusLen > STATUS_LINE_CHARS) {
+        display.SetScroll(7, 7, true, Display::ScrollInterval::SCROLL_4_FRAMES,
+                          _OnScrollReset);
+    } else {
+        display.StopScroll();
+    }
+    drawList.Invalidate(DrawMask::M_STATUS);
+}
+
+void
+MainPage::_OnScrollReset()
+{
+    static_cast<MainPage *>(app.CurPage())->
+        drawList.Invalidate(DrawMask::M_STATUS);
 }
 
 u16
@@ -441,9 +400,10 @@ MainPage::_AnimationTask()
         AnimationTask();
 }
 
-void
+u16
 MainPage::CheckFlooderStatus()
 {
+    u16 mask = 0;
     u8 newStatus = flooder.GetStatus();
     u8 newError = flooder.GetErrorCode();
     if (newStatus != flooderStatus ||
@@ -465,11 +425,11 @@ MainPage::CheckFlooderStatus()
 
         if (pumpActive) {
             pumpActive = false;
-            drawMask |= DrawMask::M_PUMP;
+            mask |= DrawMask::M_PUMP;
         }
     } else {
         pumpActive = !pumpActive;
-        drawMask |= DrawMask::M_PUMP;
+        mask |= DrawMask::M_PUMP;
     }
 
     if (newStatus != Flooder::Status::DRAINING &&
@@ -477,38 +437,44 @@ MainPage::CheckFlooderStatus()
 
         if (drainActive) {
             drainActive = false;
-            drawMask |= DrawMask::M_DRAIN | DrawMask::M_FLOOD_TIME;
+            mask |= DrawMask::M_DRAIN | DrawMask::M_FLOOD_TIME;
         }
     } else {
         drainActive = !drainActive;
-        drawMask |= DrawMask::M_DRAIN;
+        mask |= DrawMask::M_DRAIN;
     }
 
     u8 level = lvlGauge.GetValue();
+    u8 percent = static_cast<u16>(level) * 100 / 0xff;
+    if (percent != waterPercent) {
+        waterPercent = percent;
+        mask |= DrawMask::M_WATER_PERCENT;
+    }
     level = static_cast<u16>(level) * MAX_WATER_LEVEL / 0xff;
     if (level != watLevelBottom) {
         watLevelBottom = level;
-        drawMask |= DrawMask::M_BOTTOM_WATER;
+        mask |= DrawMask::M_BOTTOM_WATER;
     }
 
     level = flooder.GetTopPotWaterLevel();
     level = static_cast<u16>(level) * MAX_WATER_LEVEL / 0xff;
     if (level != watLevelTop) {
         watLevelTop = level;
-        drawMask |= DrawMask::M_TOP_WATER;
+        mask |= DrawMask::M_TOP_WATER;
     }
 
     u8 dl = flooder.IsAmbientDaylight() ? 1 : 0;
     if (dl != isDaylight) {
         isDaylight = dl;
-        drawMask |= DrawMask::M_DAYLIGHT | DrawMask::M_SUNRISE | DrawMask::M_SUNSET;
+        mask |= DrawMask::M_DAYLIGHT | DrawMask::M_SUNRISE | DrawMask::M_SUNSET;
     }
 
     Time curTime = rtc.GetTime().GetTime();
     if ((curTime.min & 1) != lastMinute) {
         lastMinute = curTime.min & 1;
-        drawMask |= DrawMask::M_FLOOD_TIME;
+        mask |= DrawMask::M_FLOOD_TIME;
     }
+    return mask;
 }
 
 u16
@@ -517,54 +483,29 @@ MainPage::AnimationTask()
     AtomicSection as;
     animationDivider++;
 
-    CheckFlooderStatus();
-    rtc.Update();
+    u16 mask = CheckFlooderStatus();
 
-    drawMask |= DrawMask::M_CLOCK;
+    mask |= DrawMask::M_CLOCK;
 
     if ((animationDivider & 31) == 0) {
-        drawMask |= DrawMask::M_TEMPERATURE;
+        mask |= DrawMask::M_TEMPERATURE;
     }
-
-    if (statusLen > 18) {
-        bool pauseSet = false;
-        if (!statusPause) {
-            if (statusOffset == 0) {
-                statusScrollDir = false;
-                statusPause = true;
-                pauseSet = true;
-            } else if (statusOffset == statusLen - 18) {
-                statusScrollDir = true;
-                statusPause = true;
-                pauseSet = true;
+    drawList.Invalidate(mask);
+
+    if (statusLen > STATUS_LINE_CHARS) {
+        statusChunkPeriods++;
+        if (statusChunkPeriods >= STATUS_CHUNK_PERIODS) {
+            statusChunkPeriods = 0;
+            statusOffset += STATUS_CHUNK_CHARS;
+            if (statusOffset >= statusLen) {
+                statusOffset = 0;
             }
-        } else {
-            statusPause = false;
-        }
-
-        if (!pauseSet) {
-            if (statusScrollDir) {
-                statusOffset--;
-            } else {
-                statusOffset++;
-            }
-            Draw(DrawMask::M_STATUS);
+            drawList.Invalidate(DrawMask::M_STATUS);
         }
     }
     return ANIMATION_PERIOD;
 }
 
-void
-MainPage::GetClockText()
-{
-    Rtc::Time time = rtc.GetTime();
-    Strings::StrClockNum(time.hour, textBuf);
-    textBuf[2] = ':';
-    Strings::StrClockNum(time.min, textBuf + 3);
-    textBuf[5] = ':';
-    Strings::StrClockNum(time.sec, textBuf + 6);
-}
-
 void
 MainPage::GetTimeText(Time t)
 {
@@ -576,13 +517,5 @@ MainPage::GetTimeText(Time t)
 void
 MainPage::GetTemperatureText()
 {
-    i16 temp = rtc.GetTemperature();
-    itoa(temp >> 2, textBuf, 10);
-    u8 len = strlen(textBuf);
-    textBuf[len] = '.';
-    u8 frac = temp & 3;
-    textBuf[len + 1] = '0' + ((10 * frac + 2) >> 2);
-    textBuf[len + 2] = 0x10;
-    textBuf[len + 3] = 'C';
-    textBuf[len + 4] = 0;
+    Strings::StrTemperature(tempMonitor.GetTemperature(), textBuf);
 }
@@ -36,46 +36,38 @@ public:
     OnButtonPressed() override;
 
     virtual void
-    OnRotEncClick(bool dir) override;
-
-    virtual void
-    Poll() override;
+    OnRotEnc(i8 delta, i16 accelDelta) override;
 
     virtual bool
     RequestClose() override;
 
+    virtual void
+    OnDisplayReset() override;
+
 private:
     enum {
         POT_COL = 104,
         POT_PAGE = 1,
         MAX_WATER_LEVEL = 21,
-        ANIMATION_PERIOD = TASK_DELAY_MS(500)
-    };
-
-    enum DrawState {
-        POT_WALLS_1,
-        POT_WALLS_2,
-        POT_WALLS_3,
-        POT_WALLS_4,
-        POT_WALLS_5,
-        POT_WALLS_PUMP1,
-        POT_WALLS_PUMP2,
-        SUNRISE_ICON,
-        SUNSET_ICON,
-        TEMP_ICON,
-
-        PUMP,
-        DRAIN,
-        TOP_WATER,
-        BOTTOM_WATER,
-        STATUS,
-        DAYLIGHT,
-        CLOCK,
-        SUNRISE,
-        SUNSET,
-        TEMPERATURE,
-        FLOOD_TIME,
-        DONE
+        ANIMATION_PERIOD = TASK_DELAY_MS(500),
+        /** Number of characters fitting into status line. */
+        STATUS_LINE_CHARS = 18,
+        /** Long status text is displayed by chunks of this size, the rest of
+         * the line is a gap between chunk end and start when the line is
+         * rotated by the display hardware scrolling.
+         */
+        STATUS_CHUNK_CHARS = 16,
+        STATUS_CHUNK_COLS = STATUS_CHUNK_CHARS * (FONT_WIDTH + 1),
+        /** Number of animation periods to display one status chunk. Roughly
+         * corresponds to one full revolution of the scrolled line.
+         */
+        STATUS_CHUNK_PERIODS = 12,
+        /** Large font clock location. */
+        CLOCK_PAGE = 3,
+        /** Large font bottom tank water level location. */
+        WATER_PERCENT_PAGE = 5,
+        /** Width of large font fields. */
+        LARGE_FIELD_COLS = 64
     };
 
     enum DrawMask {
@@ -91,53 +83,55 @@ private:
         M_SUNRISE =         0x0200,
         M_SUNSET =          0x0400,
         M_FLOOD_TIME =      0x0800,
+        M_WATER_PERCENT =   0x1000,
 
         M_ALL = M_STATIC | M_PUMP | M_DRAIN | M_TOP_WATER | M_BOTTOM_WATER |
                 M_STATUS | M_CLOCK | M_TEMPERATURE | M_DAYLIGHT | M_SUNRISE |
-                M_SUNSET | M_FLOOD_TIME
+                M_SUNSET | M_FLOOD_TIME | M_WATER_PERCENT
     };
 
-    u8 drawState:5,
-       drawInProgress:1,
-       closeRequested:1,
+    u8 closeRequested:1,
        pumpActive:1,
+       :6,
 
        watLevelTop:5,
        drainActive:1,
        isStatusPgm:1,
-       /** Current scrolling direction of long status text. */
-       statusScrollDir:1,
+       :1,
 
        watLevelBottom:5,
-       statusPause:1,
+       :1,
        isDaylight:1,
        /** Minute counter for once per minute refreshes. */
        lastMinute:1;
 
-    u16 drawMask;
+    static const DrawList::Op drawOps[] PROGMEM;
+    DrawList drawList;
+
     const char *status = nullptr;
     /** Length of status string. */
     u8 statusLen = 0,
-    /** Current scrolling offset of long status string. */
-       statusOffset;
+    /** Offset of currently displayed chunk of long status string. */
+       statusOffset,
+    /** Animation periods counter for status chunk switching. */
+       statusChunkPeriods;
 
     /** Used to divide animation frequency, continuously incremented. */
     u8 animationDivider;
 
+    /** Currently displayed clock value, minutes since midnight. */
+    u16 shownClock = 0xffff;
+    /** Currently displayed bottom tank water level, percents. */
+    u8 waterPercent = 0xff;
+
     u8 flooderStatus:3,
        flooderError:3,
        :2;
 
     char textBuf[18];
 
-    void
-    Draw(u16 mask);
-
-    void
-    DrawHandler();
-
-    static void
-    _DrawHandler();
+    /** Frequently updated fields, only changed characters are redrawn. */
+    TextField floodTimeField, temperatureField;
 
     bool
     DisplayOutputHandler(u8 column, u8 page, u8 *data);
@@ -145,27 +139,60 @@ private:
     static bool
     _DisplayOutputHandler(u8 column, u8 page, u8 *data);
 
-    /** Issue draw request depending on current draw state. Promote current
-     * draw state if necessary.
-     */
-    void
-    IssueDrawRequest();
+    /* Draw operations. */
+    u8
+    DrawPump();
+
+    u8
+    DrawDrain();
+
+    u8
+    DrawTopWater();
+
+    u8
+    DrawBottomWater();
+
+    u8
+    DrawStatus();
+
+    u8
+    DrawDaylight();
+
+    u8
+    DrawClock();
+
+    u8
+    DrawWaterPercent();
+
+    u8
+    DrawSunrise();
+
+    u8
+    DrawSunset();
+
+    u8
+    DrawTemperature();
+
+    u8
+    DrawFloodTime();
 
     void
     SetStatus(const char *status, bool isPgm);
 
-    void
+    /** @return Mask of elements to redraw. */
+    u16
     CheckFlooderStatus();
 
+    /** Status line is redrawn after hardware scrolling deactivation. */
+    static void
+    _OnScrollReset();
+
     static u16
     _AnimationTask();
 
     u16
     AnimationTask();
 
-    void
-    GetClockText();
-
     void
     GetTimeText(Time t);
 
@@ -12,40 +12,22 @@ using namespace adk;
 
 u8 Menu::returnPos;
 
+const DrawList::Op Menu::drawOps[NUM_DRAW_OPS] PROGMEM = {
+    DrawList::CustomOp(1 << 0, DrawList::Method<Menu, &Menu::DrawLine<0>>),
+    DrawList::CustomOp(1 << 1, DrawList::Method<Menu, &Menu::DrawLine<1>>),
+    DrawList::CustomOp(1 << 2, DrawList::Method<Menu, &Menu::DrawLine<2>>),
+    DrawList::CustomOp(1 << 3, DrawList::Method<Menu, &Menu::DrawLine<3>>),
+    DrawList::CustomOp(1 << 4, DrawList::Method<Menu, &Menu::DrawLine<4>>),
+    DrawList::CustomOp(1 << 5, DrawList::Method<Menu, &Menu::DrawLine<5>>),
+    DrawList::CustomOp(1 << 6, DrawList::Method<Menu, &Menu::DrawLine<6>>),
+    DrawList::CustomOp(1 << 7, DrawList::Method<Menu, &Menu::DrawLine<7>>),
+    DrawList::CustomOp(M_UP_ICON, DrawList::Method<Menu, &Menu::DrawUpIcon>),
+    DrawList::CustomOp(M_DOWN_ICON, DrawList::Method<Menu, &Menu::DrawDownIcon>)
+};
+
 void
 Menu::Initialize()
 {
-    drawInProgress = false;
-    drawPending = false;
-    closeRequested = false;
-
-    numItems = 0;
-    const char *p = items;
-    bool prevNull = false, charSeen = false;
-    while (true) {
-        char c;
-        if (isPgm) {
-            c = pgm_read_byte(p);
-        } else {
-            c = *p;
-        }
-        p++;
-        if (!c) {
-            charSeen = false;
-            if (prevNull) {
-                break;
-            } else {
-                prevNull = true;
-            }
-        } else {
-            prevNull = false;
-            if (!charSeen) {
-                numItems++;
-                charSeen = true;
-            }
-        }
-    }
-
     if (curItem >= numItems) {
         curItem = numItems - 1;
     }
@@ -59,145 +41,103 @@ Menu::Initialize()
         topItem = 0;
     }
 
-    Draw();
-}
+    shownTop = topItem;
+    shownItem = curItem;
+    upIconValid = false;
+    downIconValid = false;
 
-const char *
-Menu::SkipItems(const char *p, u8 num)
-{
-    bool prevNull = false, charSeen = false;
-    while (num) {
-        char c;
-        if (isPgm) {
-            c = pgm_read_byte(p);
-        } else {
-            c = *p;
-        }
-        p++;
-        if (!c) {
-            charSeen = false;
-            if (prevNull) {
-                break;
-            } else {
-                prevNull = true;
-                num--;
-            }
-        } else {
-            prevNull = false;
-            if (!charSeen) {
-                charSeen = true;
-            }
-        }
-    }
-    return p;
+    drawList.Invalidate(DrawMask::M_ALL);
 }
 
 void
 Menu::Draw()
 {
     AtomicSection as;
-    if (closeRequested) {
-        return;
-    }
-    if (drawInProgress) {
-        drawPending = true;
-        return;
-    }
-    drawInProgress = true;
-    drawState = DrawState::ITEMS;
-    curDrawItem = 0;
-    curDrawItemText = SkipItems(items, topItem);
-    bool isSel = topItem + curDrawItem == curItem;
-    if (isPgm) {
-        textWriter.Write(Display::Viewport {LEFT_GAP, 127, 0, 0},
-                         curDrawItemText, isSel, true, _DrawHandler);
+    u16 mask;
+    if (topItem != shownTop) {
+        /* Window shifted, all lines changed. */
+        mask = DrawMask::M_ALL;
+    } else if (curItem != shownItem) {
+        /* Only selection moved within the window. */
+        mask = (1 << (shownItem - topItem)) | (1 << (curItem - topItem));
     } else {
-        textWriter.Write(Display::Viewport {LEFT_GAP, 127, 0, 0},
-                         const_cast<char *>(curDrawItemText), isSel, true,
-                         _DrawHandler);
+        return;
     }
+    shownTop = topItem;
+    shownItem = curItem;
+    drawList.Invalidate(mask);
 }
 
-void
-Menu::DrawHandler()
+template <u8 line>
+u8
+Menu::DrawLine()
 {
-    AtomicSection as;
-
-    if (closeRequested || drawPending) {
-        drawInProgress = false;
-        return;
-    }
-
-    while (drawState == DrawState::ITEMS) {
-        if (curDrawItem >= NUM_LINES - 1 ||
-            curDrawItem + topItem >= numItems - 1) {
-
-            drawState = DrawState::UP_ICON;
-            break;
-        }
-
-        curDrawItem++;
-        curDrawItemText = SkipItems(curDrawItemText, 1);
-        bool isSel = topItem + curDrawItem == curItem;
-        if (isPgm) {
-            textWriter.Write(Display::Viewport {LEFT_GAP, 127, curDrawItem, curDrawItem},
-                             curDrawItemText, isSel, true, _DrawHandler);
-        } else {
-            textWriter.Write(Display::Viewport {LEFT_GAP, 127, curDrawItem, curDrawItem},
-                             const_cast<char *>(curDrawItemText), isSel, true,
-                             _DrawHandler);
-        }
-        return;
-    }
-
-    while (drawState == DrawState::UP_ICON) {
-        drawState = DrawState::DOWN_ICON;
-        if (topItem == 0) {
-            bitmapWriter.Clear(0, 0, &bitmaps.Up, false, _DrawHandler);
-        } else {
-            bitmapWriter.Write(0, 0, &bitmaps.Up, false, _DrawHandler);
-        }
-        return;
-    }
+    u8 idx = shownTop + line;
+    if (idx >= numItems) {
+        return DrawList::Result::SKIP;
+    }
+    textWriter.Write(Display::Viewport {LEFT_GAP, 127, line, line},
+                     GetItem(idx), idx == shownItem, true,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
+}
 
-    while (drawState == DrawState::DOWN_ICON) {
-        drawState = DrawState::DONE;
-        if (numItems - topItem <= NUM_LINES) {
-            bitmapWriter.Clear(0, 7, &bitmaps.Down, false, _DrawHandler);
-        } else {
-            bitmapWriter.Write(0, 7, &bitmaps.Down, false, _DrawHandler);
-        }
-        return;
+u8
+Menu::DrawUpIcon()
+{
+    bool show = shownTop != 0;
+    if (upIconValid && upIconShown == show) {
+        return DrawList::Result::SKIP;
+    }
+    upIconValid = true;
+    upIconShown = show;
+    if (show) {
+        bitmapWriter.Write(0, 0, &bitmaps.Up, false, DrawList::_DoneHandler);
+    } else {
+        bitmapWriter.Clear(0, 0, &bitmaps.Up, false, DrawList::_DoneHandler);
     }
-
-    drawInProgress = false;
+    return DrawList::Result::CONTINUE;
 }
 
-void
-Menu::_DrawHandler()
+u8
+Menu::DrawDownIcon()
 {
-    static_cast<Menu *>(app.CurPage())->DrawHandler();
+    bool show = numItems - shownTop > NUM_LINES;
+    if (downIconValid && downIconShown == show) {
+        return DrawList::Result::SKIP;
+    }
+    downIconValid = true;
+    downIconShown = show;
+    if (show) {
+        bitmapWriter.Write(0, 7, &bitmaps.Down, false, DrawList::_DoneHandler);
+    } else {
+        bitmapWriter.Clear(0, 7, &bitmaps.Down, false, DrawList::_DoneHandler);
+    }
+    return DrawList::Result::CONTINUE;
 }
 
 void
 Menu::OnButtonPressed()
 {
-    if (!closeRequested) {
+    if (!drawList.IsClosed()) {
         OnItemSelected(curItem);
     }
 }
 
 void
-Menu::OnRotEncClick(bool dir)
+Menu::OnRotEnc(i8 delta, i16 accelDelta __UNUSED)
 {
     AtomicSection as;
-    if (dir) {
-        if (curItem < numItems - 1) {
-            curItem++;
-        }
-    } else if (curItem > 0) {
-        curItem--;
+    i16 item = curItem + delta;
+    if (item >= numItems) {
+        item = numItems - 1;
+    } else if (item < 0) {
+        item = 0;
     }
+    if (item == curItem) {
+        return;
+    }
+    curItem = item;
     if (topItem < curItem && curItem - topItem >= NUM_LINES) {
         topItem = curItem + 1 - NUM_LINES;
     } else if (topItem > curItem) {
@@ -206,23 +146,19 @@ Menu::OnRotEncClick(bool dir)
     Draw();
 }
 
-void
-Menu::Poll()
+bool
+Menu::RequestClose()
 {
-    Page::Poll();
-    AtomicSection as;
-    if (drawPending && !drawInProgress) {
-        drawPending = false;
-        Draw();
-    }
+    return drawList.Close();
 }
 
-bool
-Menu::RequestClose()
+void
+Menu::OnDisplayReset()
 {
     AtomicSection as;
-    closeRequested = true;
-    return !drawInProgress;
+    upIconValid = false;
+    downIconValid = false;
+    drawList.Invalidate(DrawMask::M_ALL);
 }
 
 void
@@ -30,26 +30,19 @@ public:
     /** Optional external selection handler. */
     ItemHandler itemHandler = nullptr;
 
-    /** @param items Item strings. Additional null terminator after last item.
+    /** @param items Item strings in program memory, defined by DEF_MENU.
      *  @param pos Initially selected item index.
      *  @param actions Default page navigation actions. Size should be equal to
      *      number of items in "items" argument.
      *  @param returnAction Return action index if special handling needed, -1
      *      if not needed.
      */
-    Menu(char *items, u8 pos = 0, const Action *actions = nullptr,
-         i8 returnAction = -1):
-        items(items), actions(actions), isPgm(false), curItem(pos),
-        returnAction(returnAction)
-    {
-        Initialize();
-    }
-
-    /** Additional null terminator after last item. */
-    Menu(const char *items, u8 pos = 0, const Action *actions = nullptr,
-         i8 returnAction = -1):
-        items(items), actions(actions), isPgm(true), curItem(pos),
-        returnAction(returnAction)
+    template <u8 n, u16 size>
+    Menu(const MenuItems<n, size> &items, u8 pos = 0,
+         const Action *actions = nullptr, i8 returnAction = -1):
+        drawList(this, drawOps, NUM_DRAW_OPS),
+        items(items.text), offsets(items.offsets), actions(actions),
+        curItem(pos), numItems(n), returnAction(returnAction)
     {
         Initialize();
     }
@@ -62,14 +55,14 @@ public:
     OnButtonPressed() override;
 
     virtual void
-    OnRotEncClick(bool dir) override;
-
-    virtual void
-    Poll() override;
+    OnRotEnc(i8 delta, i16 accelDelta) override;
 
     virtual bool
     RequestClose() override;
 
+    virtual void
+    OnDisplayReset() override;
+
     /** Find action with the specified fabric in the provided actions array.
      *
      * @param actions Actions array.
@@ -85,46 +78,63 @@ public:
 private:
     enum {
         NUM_LINES = 8,
-        LEFT_GAP = 5
+        LEFT_GAP = 5,
+        /** Line operations followed by two scroll icons operations. */
+        NUM_DRAW_OPS = NUM_LINES + 2
     };
 
-    enum DrawState {
-        ITEMS,
-        UP_ICON,
-        DOWN_ICON,
-        DONE
+    enum DrawMask {
+        /** Bits 0..NUM_LINES-1 correspond to item lines. */
+        M_LINES =       0xff,
+        M_UP_ICON =     0x100,
+        M_DOWN_ICON =   0x200,
+
+        M_ALL = M_LINES | M_UP_ICON | M_DOWN_ICON
     };
 
+    static const DrawList::Op drawOps[NUM_DRAW_OPS] PROGMEM;
+    DrawList drawList;
+
     const char *items;
+    /** Items offsets in program memory. */
+    const u8 *offsets;
     const Action *actions;
 
-    u8 isPgm:1,
-       drawInProgress:1,
-       drawPending:1,
-       closeRequested:1,
-       drawState:2,
-       reserved:2,
-
-       curDrawItem:3;
-    const char *curDrawItemText;
+    /** Scroll icons displayed state. */
+    u8 upIconShown:1,
+       downIconShown:1,
+       upIconValid:1,
+       downIconValid:1,
+       reserved:4;
 
     u8 curItem, numItems, topItem;
+    /** Top and selected item currently displayed (or being drawn). */
+    u8 shownTop, shownItem;
     i8 returnAction;
 
     void
     Initialize();
 
+    /** Invalidate elements changed since last draw. */
     void
     Draw();
 
-    void
-    DrawHandler();
+    template <u8 line>
+    u8
+    DrawLine();
 
-    static void
-    _DrawHandler();
+    u8
+    DrawUpIcon();
 
+    u8
+    DrawDownIcon();
+
+    /** Get item text in program memory. */
     const char *
-    SkipItems(const char *p, u8 num);
+    GetItem(u8 idx)
+    {
+        return items + pgm_read_byte(&offsets[idx]);
+    }
 } __PACKED;
 
 #include "menus.h"
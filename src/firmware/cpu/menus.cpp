@@ -72,7 +72,10 @@ const Menu::Action actions[] = {
     {Application::GetPageTypeCode<Menu>(), MainMenu::Fabric},
     {0, nullptr},
     {Application::GetPageTypeCode<Menu>(), LvlGaugeCalibrationMenu::Fabric},
-    {0, nullptr},
+    {Application::GetPageTypeCode<ClbTemperature::TPage>(),
+     ClbTemperature::Fabric},
+    {Application::GetPageTypeCode<Menu>(), ProbeCalibrationMenu::FabricEc},
+    {Application::GetPageTypeCode<Menu>(), ProbeCalibrationMenu::FabricPh},
     MENU_ACTIONS_END
 };
 
@@ -91,8 +94,11 @@ namespace SetupMenu {
 const Menu::Action actions[] = {
     {Application::GetPageTypeCode<Menu>(), MainMenu::Fabric},
     {Application::GetPageTypeCode<SetupTime::TPage>(), SetupTime::Fabric},
+    {Application::GetPageTypeCode<SetupDate::TPage>(), SetupDate::Fabric},
     {Application::GetPageTypeCode<Menu>(), FloodingSetupMenu::Fabric},
-    {0, nullptr},
+    {Application::GetPageTypeCode<SetupLighting::TPage>(), SetupLighting::Fabric},
+    {Application::GetPageTypeCode<SetupNutrients::TPage>(),
+     SetupNutrients::Fabric},
     MENU_ACTIONS_END
 };
 
@@ -124,6 +130,8 @@ const Menu::Action actions[] = {
                                   SetupFlooding_FloodPeriod::Fabric},
     {Application::GetPageTypeCode<SetupFlooding_MaxSunsetTime::TPage>(),
                                   SetupFlooding_MaxSunsetTime::Fabric},
+    {Application::GetPageTypeCode<SetupFlooding_Latitude::TPage>(),
+                                  SetupFlooding_Latitude::Fabric},
     MENU_ACTIONS_END
 };
 
@@ -147,7 +155,14 @@ const Menu::Action actions[] = {
      Status_LightSensor::FabricA},
     {Application::GetPageTypeCode<Status_LightSensor::TPage>(),
      Status_LightSensor::FabricB},
-    {0, nullptr},
+    {Application::GetPageTypeCode<Status_Temperature::TPage>(),
+     Status_Temperature::Fabric},
+    {Application::GetPageTypeCode<Status_Stack::TPage>(), Status_Stack::Fabric},
+    {Application::GetPageTypeCode<Status_I2c::TPage>(), Status_I2c::Fabric},
+    {Application::GetPageTypeCode<Status_Nutrients::TPage>(),
+     Status_Nutrients::FabricEc},
+    {Application::GetPageTypeCode<Status_Nutrients::TPage>(),
+     Status_Nutrients::FabricPh},
     MENU_ACTIONS_END
 };
 
@@ -180,3 +195,54 @@ Fabric(void *p)
 }
 
 } /* namespace LvlGaugeCalibrationMenu */
+
+
+namespace ProbeCalibrationMenu {
+
+const Menu::Action actions[] = {
+    {Application::GetPageTypeCode<Menu>(), CalibrationMenu::Fabric},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    MENU_ACTIONS_END
+};
+
+static u8 probe;
+
+bool
+CustomActionHandler(u8 idx)
+{
+    if (idx == 0) {
+        return false;
+    }
+    ClbNutrients::SetPoint(probe, idx - 1);
+    app.SetNextPage(Application::GetPageTypeCode<ClbNutrients::TPage>(),
+                    ClbNutrients::Fabric);
+    return true;
+}
+
+static void
+Create(void *p)
+{
+    Menu *menu = new (p) Menu(strings.ProbeCalibrationMenu, Menu::returnPos,
+                              actions, 0);
+    menu->itemHandler = CustomActionHandler;
+}
+
+void
+FabricEc(void *p)
+{
+    probe = Nutrients::PROBE_EC;
+    Create(p);
+    Menu::returnPos = Menu::FindAction(CalibrationMenu::actions, FabricEc);
+}
+
+void
+FabricPh(void *p)
+{
+    probe = Nutrients::PROBE_PH;
+    Create(p);
+    Menu::returnPos = Menu::FindAction(CalibrationMenu::actions, FabricPh);
+}
+
+} /* namespace ProbeCalibrationMenu */
@@ -58,5 +58,16 @@ namespace LvlGaugeCalibrationMenu {
     Fabric(void *p);
 }
 
+/** Calibration points of EC or pH probe. */
+namespace ProbeCalibrationMenu {
+    extern const Menu::Action actions[] PROGMEM;
+
+    void
+    FabricEc(void *p);
+
+    void
+    FabricPh(void *p);
+}
+
 
 #endif /* MENUS_H_ */
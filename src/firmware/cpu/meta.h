@@ -0,0 +1,56 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file meta.h
+ * Helpers for compile-time generation of data tables.
+ */
+
+#ifndef META_H_
+#define META_H_
+
+namespace meta {
+
+/** Sequence of indices, used for expanding generator function into array
+ * initializer: { Gen(idx)... }.
+ */
+template <u16... idx>
+struct IndexSeq {};
+
+namespace internal {
+
+template <class TSeq1, class TSeq2>
+struct ConcatSeq;
+
+template <u16... idx1, u16... idx2>
+struct ConcatSeq<IndexSeq<idx1...>, IndexSeq<idx2...>> {
+    using Type = IndexSeq<idx1..., (sizeof...(idx1) + idx2)...>;
+};
+
+} /* namespace internal */
+
+/** Make sequence 0..n-1. Logarithmic instantiation depth so that long tables
+ * do not hit compiler template recursion limit.
+ */
+template <u16 n>
+struct MakeIndexSeq {
+    using Type = typename internal::ConcatSeq<
+        typename MakeIndexSeq<n / 2>::Type,
+        typename MakeIndexSeq<n - n / 2>::Type>::Type;
+};
+
+template <>
+struct MakeIndexSeq<0> {
+    using Type = IndexSeq<>;
+};
+
+template <>
+struct MakeIndexSeq<1> {
+    using Type = IndexSeq<0>;
+};
+
+} /* namespace meta */
+
+#endif /* META_H_ */
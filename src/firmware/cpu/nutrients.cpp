@@ -0,0 +1,282 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file nutrients.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+Nutrients nutrients;
+
+/* Defaults are nominal: EC cell constant 1 with 1k reference resistor, pH
+ * amplifier with 2.5V at pH 7 and -0.18V/pH.
+ */
+Nutrients::ClbPoint EEMEM Nutrients::eeClbPoints[NUM_PROBES][NUM_CLB_POINTS] = {
+    {{1024, 1000}, {0xffff, 0}, {0xffff, 0}},
+    {{2490, 400}, {2048, 700}, {1606, 1000}}
+};
+i16 EEMEM Nutrients::eePhClbTemp = 25 * 4;
+/* Checks are disabled by default. */
+u16 EEMEM Nutrients::eeMinLimit[NUM_PROBES] = {0, 0},
+          Nutrients::eeMaxLimit[NUM_PROBES] = {0, 0};
+
+void
+Nutrients::_OnAdcResult(u8 channel, u16 value)
+{
+    nutrients.OnAdcResult(channel, value);
+}
+
+bool
+Nutrients::_OnAdcStart(u8)
+{
+    /* Excitation is applied only while the phase conversions run. */
+    nutrients.SetExcitation(static_cast<EcPhase>(nutrients.ecPhase));
+    return true;
+}
+
+void
+Nutrients::OnAdcResult(u8 channel, u16 value)
+{
+    if (channel == AdcChannel::PH_SENSOR) {
+        phSample = value;
+        return;
+    }
+    SetExcitation(EcPhase::EC_IDLE);
+    if (ecPhase == EcPhase::EC_FORWARD) {
+        ecForward = value;
+        ecPhase = EcPhase::EC_REVERSE;
+        adc.ScheduleConversion(AdcChannel::EC_SENSOR);
+    } else if (ecPhase == EcPhase::EC_REVERSE) {
+        ecPhase = EcPhase::EC_IDLE;
+        /* Reverse polarity reading is complementary. */
+        ecSample = (static_cast<u32>(ecForward) + ADC_FULL_SCALE - 1 - value) /
+            2;
+        /* pH probe is measured with excitation off. */
+        adc.ScheduleConversion(AdcChannel::PH_SENSOR);
+    }
+}
+
+void
+Nutrients::SetExcitation(EcPhase phase)
+{
+    if (phase == EcPhase::EC_FORWARD) {
+        AVR_BIT_CLR8(AVR_REG_PORT(EC_EXC_B_PORT), EC_EXC_B_PIN);
+        AVR_BIT_SET8(AVR_REG_PORT(EC_EXC_A_PORT), EC_EXC_A_PIN);
+    } else if (phase == EcPhase::EC_REVERSE) {
+        AVR_BIT_CLR8(AVR_REG_PORT(EC_EXC_A_PORT), EC_EXC_A_PIN);
+        AVR_BIT_SET8(AVR_REG_PORT(EC_EXC_B_PORT), EC_EXC_B_PIN);
+    } else {
+        AVR_BIT_CLR8(AVR_REG_PORT(EC_EXC_A_PORT), EC_EXC_A_PIN);
+        AVR_BIT_CLR8(AVR_REG_PORT(EC_EXC_B_PORT), EC_EXC_B_PIN);
+    }
+}
+
+void
+Nutrients::Enable()
+{
+    AVR_BIT_SET8(AVR_REG_DDR(EC_EXC_A_PORT), EC_EXC_A_PIN);
+    AVR_BIT_SET8(AVR_REG_DDR(EC_EXC_B_PORT), EC_EXC_B_PIN);
+    ecPhase = EcPhase::EC_IDLE;
+    SetExcitation(EcPhase::EC_IDLE);
+    measured = false;
+    filterValid = false;
+    for (u8 i = 0; i < NUM_PROBES; i++) {
+        curRaw[i] = 0;
+        curValue[i] = INVALID_VALUE;
+    }
+    adc.SetOversampling(AdcChannel::EC_SENSOR, SENSOR_OVERSAMPLING);
+    adc.SetOversampling(AdcChannel::PH_SENSOR, SENSOR_OVERSAMPLING);
+    scheduler.ScheduleTask(PeriodicTask, MEASUREMENT_PERIOD);
+}
+
+u16
+Nutrients::PeriodicTask()
+{
+    /* Results of the previous measurement are available now. */
+    if (nutrients.measured) {
+        nutrients.Update();
+    }
+    nutrients.measured = true;
+    AtomicSection as;
+    /* Excitation is switched on by the ADC start handler. */
+    nutrients.ecPhase = EcPhase::EC_FORWARD;
+    adc.ScheduleConversion(AdcChannel::EC_SENSOR);
+    return MEASUREMENT_PERIOD;
+}
+
+void
+Nutrients::Update()
+{
+    u16 samples[NUM_PROBES];
+    {
+        AtomicSection as;
+        samples[PROBE_EC] = ecSample;
+        samples[PROBE_PH] = phSample;
+    }
+    for (u8 i = 0; i < NUM_PROBES; i++) {
+        u16 target = samples[i] << FILTER_FRAC_BITS;
+        if (!filterValid) {
+            filtered[i] = target;
+        } else if (target > filtered[i]) {
+            filtered[i] += (target - filtered[i]) >> FILTER_SHIFT;
+        } else {
+            filtered[i] -= (filtered[i] - target) >> FILTER_SHIFT;
+        }
+    }
+    filterValid = true;
+
+    i16 temp = tempMonitor.GetTemperature();
+
+    /* Probe to reference resistance ratio is v / (1 - v), conductance is the
+     * inverse.
+     */
+    u32 v = filtered[PROBE_EC];
+    u32 ec;
+    if (v == 0) {
+        ec = 0xffff;
+    } else {
+        ec = ((static_cast<u32>(ADC_FULL_SCALE) << FILTER_FRAC_BITS) - v) *
+            EC_RAW_SCALE / v;
+        if (ec > 0xffff) {
+            ec = 0xffff;
+        }
+    }
+    /* Conductance grows by 1.9% per degree, 1/1024 units. */
+    i16 factor = 1024 + (temp - 25 * 4) * 39 / 8;
+    if (factor < 256) {
+        factor = 256;
+    }
+    ec = ec * 1024 / factor;
+    if (ec > 0xffff) {
+        ec = 0xffff;
+    }
+    curRaw[PROBE_EC] = ec;
+    curRaw[PROBE_PH] = filtered[PROBE_PH] >> FILTER_FRAC_BITS;
+
+    curValue[PROBE_EC] = Interpolate(PROBE_EC, curRaw[PROBE_EC]);
+
+    u16 ph = Interpolate(PROBE_PH, curRaw[PROBE_PH]);
+    if (ph != INVALID_VALUE) {
+        /* Electrode slope is proportional to absolute temperature. */
+        i16 clbTemp = eeprom_read_word(reinterpret_cast<u16 *>(&eePhClbTemp));
+        i32 p = 700 + (static_cast<i32>(ph) - 700) * (clbTemp - ZERO_KELVIN) /
+            (temp - ZERO_KELVIN);
+        if (p < 0) {
+            p = 0;
+        } else if (p > MAX_PH) {
+            p = MAX_PH;
+        }
+        ph = p;
+    }
+    curValue[PROBE_PH] = ph;
+}
+
+u16
+Nutrients::Interpolate(u8 probe, u16 raw)
+{
+    /* Zero conductance is implicit EC calibration point. */
+    ClbPoint points[NUM_CLB_POINTS + 1];
+    u8 n = 0;
+    if (probe == PROBE_EC) {
+        points[0].raw = 0;
+        points[0].value = 0;
+        n = 1;
+    }
+    for (u8 i = 0; i < NUM_CLB_POINTS; i++) {
+        ClbPoint pt = GetClbPoint(probe, i);
+        if (pt.value == 0) {
+            continue;
+        }
+        /* Insertion sort by raw value. */
+        u8 j = n;
+        while (j > 0 && points[j - 1].raw > pt.raw) {
+            points[j] = points[j - 1];
+            j--;
+        }
+        points[j] = pt;
+        n++;
+    }
+    if (n < 2) {
+        return INVALID_VALUE;
+    }
+
+    /* Extrapolate by the first or the last segment beyond the points. */
+    u8 i = 0;
+    while (i < n - 2 && raw > points[i + 1].raw) {
+        i++;
+    }
+    i32 dRaw = static_cast<i32>(points[i + 1].raw) - points[i].raw;
+    if (dRaw == 0) {
+        return points[i].value;
+    }
+    i32 value = points[i].value +
+        (static_cast<i32>(raw) - points[i].raw) *
+        (static_cast<i32>(points[i + 1].value) - points[i].value) / dRaw;
+    u16 maxValue = probe == PROBE_EC ? MAX_EC : MAX_PH;
+    if (value < 0) {
+        value = 0;
+    } else if (value > maxValue) {
+        value = maxValue;
+    }
+    return value;
+}
+
+Nutrients::ClbPoint
+Nutrients::GetClbPoint(u8 probe, u8 idx)
+{
+    ClbPoint pt;
+    eeprom_read_block(&pt, &eeClbPoints[probe][idx], sizeof(pt));
+    return pt;
+}
+
+void
+Nutrients::SetClbPoint(u8 probe, u8 idx, u16 value)
+{
+    ClbPoint pt;
+    pt.raw = value ? curRaw[probe] : 0xffff;
+    pt.value = value;
+    eeprom_update_block(&pt, &eeClbPoints[probe][idx], sizeof(pt));
+    if (probe == PROBE_PH && value) {
+        eeprom_update_word(reinterpret_cast<u16 *>(&eePhClbTemp),
+                           tempMonitor.GetTemperature());
+    }
+}
+
+u16
+Nutrients::GetMinLimit(u8 probe)
+{
+    return eeprom_read_word(&eeMinLimit[probe]);
+}
+
+u16
+Nutrients::GetMaxLimit(u8 probe)
+{
+    return eeprom_read_word(&eeMaxLimit[probe]);
+}
+
+void
+Nutrients::SetLimits(u8 probe, u16 minValue, u16 maxValue)
+{
+    eeprom_update_word(&eeMinLimit[probe], minValue);
+    eeprom_update_word(&eeMaxLimit[probe], maxValue);
+}
+
+bool
+Nutrients::IsInRange()
+{
+    for (u8 i = 0; i < NUM_PROBES; i++) {
+        u16 maxValue = GetMaxLimit(i);
+        u16 value = curValue[i];
+        if (maxValue == 0 || value == INVALID_VALUE) {
+            continue;
+        }
+        if (value < GetMinLimit(i) || value > maxValue) {
+            return false;
+        }
+    }
+    return true;
+}
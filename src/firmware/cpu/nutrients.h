@@ -0,0 +1,186 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file nutrients.h */
+
+#ifndef NUTRIENTS_H_
+#define NUTRIENTS_H_
+
+/** Nutrient solution monitoring by EC and pH probes.
+ *
+ * EC probe is connected in series with the reference resistor between
+ * excitation lines A and B, the junction is connected to EC_SENSOR ADC channel.
+ * The probe is measured in both polarities and the excitation is off between
+ * measurements so that there is no DC current through the solution. Each
+ * polarity is switched on right before its conversions start and off once
+ * they are done, so both phases have equal duration. The first conversion
+ * after the switch is discarded while the electrodes settle. pH probe
+ * amplifier output is connected to PH_SENSOR ADC channel.
+ *
+ * Both probes are calibrated by up to NUM_CLB_POINTS reference solutions,
+ * values between the points are linearly interpolated. EC is compensated to
+ * 25C, pH probe slope is scaled by absolute temperature relatively to the
+ * calibration temperature. Temperature is taken from the temperature monitor.
+ */
+class Nutrients {
+public:
+    enum AdcChannel {
+        EC_SENSOR = 2,
+        PH_SENSOR = 3
+    };
+
+    enum Probe {
+        PROBE_EC,
+        PROBE_PH,
+        NUM_PROBES
+    };
+
+    enum {
+        NUM_CLB_POINTS = 3,
+        /** Value for not calibrated probe. */
+        INVALID_VALUE = 0xffff,
+        /** Maximal EC value, uS/cm. */
+        MAX_EC = 20000,
+        /** Maximal pH value, pH units multiplied by 100. */
+        MAX_PH = 1400
+    };
+
+    /** Calibration point. */
+    struct ClbPoint {
+        /** Raw probe reading, see GetRaw(). */
+        u16 raw;
+        /** Reference solution value, zero for unused point. */
+        u16 value;
+    } __PACKED;
+
+    void
+    Enable();
+
+    /** Filtered probe value, EC in uS/cm at 25C or pH multiplied by 100.
+     * INVALID_VALUE if the probe is not calibrated.
+     */
+    u16
+    GetValue(u8 probe)
+    {
+        return curValue[probe];
+    }
+
+    /** Filtered raw probe reading. Conductance in units of the reference
+     * resistor conductance divided by EC_RAW_SCALE (temperature compensated)
+     * for EC probe, ADC reading for pH probe.
+     */
+    u16
+    GetRaw(u8 probe)
+    {
+        return curRaw[probe];
+    }
+
+    static ClbPoint
+    GetClbPoint(u8 probe, u8 idx);
+
+    /** Calibrate the point by the current raw reading.
+     *
+     * @param probe Probe index.
+     * @param idx Point index.
+     * @param value Reference solution value, zero to clear the point.
+     */
+    void
+    SetClbPoint(u8 probe, u8 idx, u16 value);
+
+    /** Acceptable range for flooding, both zero if not checked. */
+    static u16
+    GetMinLimit(u8 probe);
+
+    static u16
+    GetMaxLimit(u8 probe);
+
+    static void
+    SetLimits(u8 probe, u16 minValue, u16 maxValue);
+
+    /** Check whether all calibrated probes with limits set are in the
+     * acceptable range.
+     */
+    bool
+    IsInRange();
+
+    /** ADC result handler for probe channels. */
+    static void
+    _OnAdcResult(u8 channel, u16 value);
+
+    /** ADC start handler for EC probe channel, switches the excitation. */
+    static bool
+    _OnAdcStart(u8 channel);
+
+private:
+    enum {
+        MEASUREMENT_PERIOD = TASK_DELAY_S(2),
+        /** Additional sensor resolution bits by ADC oversampling. */
+        SENSOR_OVERSAMPLING = 2,
+        ADC_FULL_SCALE = 1 << (10 + SENSOR_OVERSAMPLING),
+        /** Fractional bits of filtered ADC readings. */
+        FILTER_FRAC_BITS = 4,
+        /** Exponential smoothing factor as power of two. */
+        FILTER_SHIFT = 3,
+        /** EC raw value for probe resistance equal to the reference
+         * resistor.
+         */
+        EC_RAW_SCALE = 1024,
+        /** 0K in 1/4C units. */
+        ZERO_KELVIN = -1093
+    };
+
+    enum EcPhase {
+        EC_IDLE,
+        EC_FORWARD,
+        EC_REVERSE
+    };
+
+    /** Filtered ADC readings, 12.4 fixed point. */
+    u16 filtered[NUM_PROBES];
+    u16 curRaw[NUM_PROBES];
+    u16 curValue[NUM_PROBES];
+    /** Last samples from interrupt. EC sample is polarities average. */
+    u16 ecSample, phSample;
+    u16 ecForward;
+    /** EC measurement phase, EcPhase. */
+    u8 ecPhase:2,
+    /** First measurement is scheduled. */
+       measured:1,
+    /** Filters are initialized by the first measurement. */
+       filterValid:1,
+       :4;
+
+    static ClbPoint EEMEM eeClbPoints[NUM_PROBES][NUM_CLB_POINTS];
+    /** Temperature the pH probe was calibrated at, 1/4C. */
+    static i16 EEMEM eePhClbTemp;
+    static u16 EEMEM eeMinLimit[NUM_PROBES], eeMaxLimit[NUM_PROBES];
+
+    static u16
+    PeriodicTask();
+
+    void
+    OnAdcResult(u8 channel, u16 value);
+
+    /** Drive excitation lines for the specified phase, off for EC_IDLE. */
+    void
+    SetExcitation(EcPhase phase);
+
+    /** Filter last samples and recalculate values. */
+    void
+    Update();
+
+    /** Apply calibration to raw value.
+     *
+     * @return Calibrated value, INVALID_VALUE if less than two points.
+     */
+    static u16
+    Interpolate(u8 probe, u16 raw);
+
+} __PACKED;
+
+extern Nutrients nutrients;
+
+#endif /* NUTRIENTS_H_ */
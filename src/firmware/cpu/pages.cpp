@@ -15,6 +15,7 @@ namespace ManCtrl_Light {
 void
 OnClosed(u16)
 {
+    light.SetManualMode(false);
     app.SetNextPage(Application::GetPageTypeCode<Menu>(),
                     ManualControlMenu::Fabric);
 }
@@ -28,6 +29,7 @@ OnChanged(u16 value)
 void
 Fabric(void *p)
 {
+    light.SetManualMode(true);
     TPage *sel = new (p) TPage(strings.LightControl, light.GetLevel(), 0, 255);
     Menu::returnPos = Menu::FindAction(ManualControlMenu::actions, Fabric);
     sel->onClosed = OnClosed;
@@ -137,6 +139,291 @@ FabricB(void *p)
 } /* namespace Status_LightSensor */
 
 
+namespace Status_Temperature {
+
+enum {
+    /** Gauge range upper bound, 1/4C. */
+    MAX_VALUE = 50 * 4
+};
+
+/** Gauge position for the temperature, clamped to the gauge range. */
+static u16
+GetGaugeValue(i16 temp)
+{
+    if (temp < 0) {
+        return 0;
+    }
+    if (temp > MAX_VALUE) {
+        return MAX_VALUE;
+    }
+    return temp;
+}
+
+void
+OnClosed(u16)
+{
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    StatusMenu::Fabric);
+}
+
+/** Internal sensor reading is shown as hint. */
+void
+Poll()
+{
+    TPage *sel = static_cast<TPage *>(app.CurPage());
+    sel->SetValue(GetGaugeValue(tempMonitor.GetTemperature()));
+    sel->SetHint(GetGaugeValue(tempMonitor.GetInternalTemperature()));
+}
+
+/** Print as "<temperature> <degree-hours>Dh". */
+void
+Printer(u16, char *buf)
+{
+    Strings::StrTemperature(tempMonitor.GetTemperature(), buf);
+    u8 len = strlen(buf);
+    buf[len++] = ' ';
+    utoa(tempMonitor.GetDegreeHours(), buf + len, 10);
+    strcat(buf, "Dh");
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.TemperatureStatus,
+                               GetGaugeValue(tempMonitor.GetTemperature()),
+                               0, MAX_VALUE, true);
+    Menu::returnPos = Menu::FindAction(StatusMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+} /* namespace Status_Temperature */
+
+
+namespace Status_Stack {
+
+void
+OnClosed(u16)
+{
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    StatusMenu::Fabric);
+}
+
+/** Currently displayed free stack amount. */
+static u16 shownCurFree;
+
+void
+Poll()
+{
+    TPage *sel = static_cast<TPage *>(app.CurPage());
+    sel->SetValue(sysMonitor.GetMinFreeStack());
+    u16 curFree = sysMonitor.GetCurFreeStack();
+    if (curFree != shownCurFree) {
+        shownCurFree = curFree;
+        sel->RefreshValue();
+    }
+}
+
+/** Print as "<min free>/<current free>". */
+void
+Printer(u16 value, char *buf)
+{
+    utoa(value, buf, 10);
+    u8 len = strlen(buf);
+    buf[len++] = '/';
+    shownCurFree = sysMonitor.GetCurFreeStack();
+    utoa(shownCurFree, buf + len, 10);
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.StackStatus,
+                               sysMonitor.GetMinFreeStack(),
+                               0, sysMonitor.GetTotalStack(), true);
+    Menu::returnPos = Menu::FindAction(StatusMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+} /* namespace Status_Stack */
+
+
+namespace Status_I2c {
+
+void
+OnClosed(u16)
+{
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    StatusMenu::Fabric);
+}
+
+void
+Poll()
+{
+    static_cast<TPage *>(app.CurPage())->SetValue(i2cBus.GetRecoveryCount());
+}
+
+/** Print as "<bus recoveries> D<display errors> R<RTC errors>". */
+void
+Printer(u16 value, char *buf)
+{
+    utoa(value, buf, 10);
+    strcat(buf, " D");
+    u8 len = strlen(buf);
+    utoa(i2cBus.GetErrorCount(DISPLAY_ADDRESS), buf + len, 10);
+    strcat(buf, " R");
+    len = strlen(buf);
+    utoa(i2cBus.GetErrorCount(Rtc::I2C_ADDRESS), buf + len, 10);
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.I2cStatus, i2cBus.GetRecoveryCount(),
+                               0, 0xff, true);
+    Menu::returnPos = Menu::FindAction(StatusMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+} /* namespace Status_I2c */
+
+
+/** Print EC as "<value> uS/cm", pH as "<value>.<fraction>". */
+static void
+PrintNutrientValue(u8 probe, u16 value, char *buf)
+{
+    if (value == Nutrients::INVALID_VALUE) {
+        strcpy_P(buf, strings.NoValue);
+        return;
+    }
+    if (probe == Nutrients::PROBE_EC) {
+        utoa(value, buf, 10);
+        strcat(buf, " uS/cm");
+        return;
+    }
+    utoa(value / 100, buf, 10);
+    u8 len = strlen(buf);
+    buf[len] = '.';
+    buf[len + 1] = '0' + value % 100 / 10;
+    buf[len + 2] = '0' + value % 10;
+    buf[len + 3] = 0;
+}
+
+
+namespace Status_Nutrients {
+
+struct {
+    u8 probe:1;
+} g;
+
+void
+OnClosed(u16)
+{
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    StatusMenu::Fabric);
+}
+
+/** Raw reading is shown as hint. */
+void
+Poll()
+{
+    TPage *sel = static_cast<TPage *>(app.CurPage());
+    u16 value = nutrients.GetValue(g.probe);
+    sel->SetValue(value == Nutrients::INVALID_VALUE ? 0 : value);
+    sel->SetHint(nutrients.GetRaw(g.probe));
+}
+
+void
+Printer(u16, char *buf)
+{
+    PrintNutrientValue(g.probe, nutrients.GetValue(g.probe), buf);
+}
+
+static void
+Create(void *p, const char *title, u16 maxValue)
+{
+    u16 value = nutrients.GetValue(g.probe);
+    TPage *sel = new (p) TPage(title,
+                               value == Nutrients::INVALID_VALUE ? 0 : value,
+                               0, maxValue, true);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+void
+FabricEc(void *p)
+{
+    g.probe = Nutrients::PROBE_EC;
+    Create(p, strings.NutrientsEc, Nutrients::MAX_EC);
+    Menu::returnPos = Menu::FindAction(StatusMenu::actions, FabricEc);
+}
+
+void
+FabricPh(void *p)
+{
+    g.probe = Nutrients::PROBE_PH;
+    Create(p, strings.NutrientsPh, Nutrients::MAX_PH);
+    Menu::returnPos = Menu::FindAction(StatusMenu::actions, FabricPh);
+}
+
+} /* namespace Status_Nutrients */
+
+
+namespace ClbTemperature {
+
+enum {
+    /** Calibration offset is 10 bits ADC reading. */
+    MAX_OFFSET = 0x3ff
+};
+
+/** Raw reading is shown as hint. */
+void
+Poll()
+{
+    static_cast<TPage *>(app.CurPage())->SetHint(tempMonitor.GetInternalRaw());
+}
+
+/** Print as "<offset> <internal sensor temperature with this offset>". */
+void
+Printer(u16 value, char *buf)
+{
+    utoa(value, buf, 10);
+    u8 len = strlen(buf);
+    buf[len++] = ' ';
+    Strings::StrTemperature(
+        tempMonitor.ConvertInternal(tempMonitor.GetInternalRaw(), value),
+        buf + len);
+}
+
+void
+OnClosed(u16)
+{
+    tempMonitor.SetCalibration(static_cast<TPage *>(app.CurPage())->GetValue(),
+                               tempMonitor.GetCalFactor());
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    CalibrationMenu::Fabric);
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.TemperatureClb,
+                               tempMonitor.GetCalOffset(), 0, MAX_OFFSET);
+    Menu::returnPos = Menu::FindAction(CalibrationMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+} /* namespace ClbTemperature */
+
+
 namespace ClbLvlGauge_MinValue {
 
 void
@@ -191,6 +478,72 @@ Fabric(void *p)
 } /* namespace ClbLvlGauge_MaxValue */
 
 
+namespace ClbNutrients {
+
+static u8 probe, point;
+
+void
+SetPoint(u8 probe, u8 point)
+{
+    ClbNutrients::probe = probe;
+    ClbNutrients::point = point;
+}
+
+/** Current raw reading is captured for the point when the page is closed,
+ * zero value clears the point.
+ */
+void
+OnClosed(u16 value)
+{
+    nutrients.SetClbPoint(probe, point, value);
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    probe == Nutrients::PROBE_EC ?
+                        ProbeCalibrationMenu::FabricEc :
+                        ProbeCalibrationMenu::FabricPh);
+}
+
+void
+Poll()
+{
+    static_cast<TPage *>(app.CurPage())->SetHint(nutrients.GetRaw(probe));
+}
+
+/** Print as "<point>: <value>". */
+void
+Printer(u16 value, char *buf)
+{
+    buf[0] = '1' + point;
+    buf[1] = ':';
+    buf[2] = ' ';
+    if (value == 0) {
+        buf[3] = '-';
+        buf[4] = 0;
+    } else {
+        PrintNutrientValue(probe, value, buf + 3);
+    }
+}
+
+void
+Fabric(void *p)
+{
+    Nutrients::ClbPoint pt = Nutrients::GetClbPoint(probe, point);
+    TPage *sel;
+    if (probe == Nutrients::PROBE_EC) {
+        sel = new (p) TPage(strings.NutrientsEcClb, pt.value, 0,
+                            Nutrients::MAX_EC);
+    } else {
+        sel = new (p) TPage(strings.NutrientsPhClb, pt.value, 0,
+                            Nutrients::MAX_PH);
+    }
+    Menu::returnPos = point + 1;
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+    sel->printer = Printer;
+}
+
+} /* namespace ClbNutrients */
+
+
 namespace SetupFlooding_PumpThrottle {
 
 void
@@ -360,6 +713,39 @@ Fabric(void *p)
 } /* namespace SetupFlooding_MaxSunsetTime */
 
 
+namespace SetupFlooding_Latitude {
+
+void
+OnClosed(u16 value)
+{
+    flooder.SetLatitude(static_cast<i16>(value) - solar::MAX_LATITUDE);
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(),
+                    FloodingSetupMenu::Fabric);
+}
+
+/** Print as "<degrees>N" or "<degrees>S". */
+void
+Printer(u16 value, char *buf)
+{
+    i16 latitude = static_cast<i16>(value) - solar::MAX_LATITUDE;
+    utoa(latitude < 0 ? -latitude : latitude, buf, 10);
+    strcat(buf, latitude < 0 ? "S" : "N");
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.FloodingLatitude,
+                               flooder.GetLatitude() + solar::MAX_LATITUDE,
+                               0, solar::MAX_LATITUDE * 2);
+    Menu::returnPos = Menu::FindAction(FloodingSetupMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->printer = Printer;
+}
+
+} /* namespace SetupFlooding_Latitude */
+
+
 namespace SetupTime {
 
 void
@@ -368,6 +754,7 @@ OnClosed(bool accepted)
     if (accepted) {
         Time time = static_cast<TimeSelector *>(app.CurPage())->GetValue();
         rtc.SetTime(Rtc::Time{time.hour, time.min, 0});
+        flooder.SchedulePoll();
     }
     app.SetNextPage(Application::GetPageTypeCode<Menu>(), SetupMenu::Fabric);
 }
@@ -383,3 +770,182 @@ Fabric(void *p)
 }
 
 } /* namespace SetupTime */
+
+
+namespace SetupDate {
+
+enum Field {
+    FIELD_YEAR,
+    FIELD_MONTH,
+    FIELD_DAY
+};
+
+/** Date being edited, fields are selected one by one. */
+static Rtc::Date date;
+static u8 field;
+
+void
+FieldFabric(void *p);
+
+void
+OnClosed(u16 value)
+{
+    if (field == FIELD_YEAR) {
+        date.year = value - 2000;
+    } else if (field == FIELD_MONTH) {
+        date.month = value;
+    } else {
+        date.day = value;
+        rtc.SetDate(date);
+        flooder.SchedulePoll();
+        app.SetNextPage(Application::GetPageTypeCode<Menu>(), SetupMenu::Fabric);
+        return;
+    }
+    field++;
+    app.SetNextPage(Application::GetPageTypeCode<TPage>(), FieldFabric);
+}
+
+void
+FieldFabric(void *p)
+{
+    TPage *sel;
+    if (field == FIELD_YEAR) {
+        sel = new (p) TPage(strings.DateSetupYear, date.year + 2000, 2000, 2099);
+    } else if (field == FIELD_MONTH) {
+        sel = new (p) TPage(strings.DateSetupMonth, date.month, 1, 12);
+    } else {
+        u8 monthDays = date.GetMonthDays();
+        if (date.day > monthDays) {
+            date.day = monthDays;
+        }
+        sel = new (p) TPage(strings.DateSetupDay, date.day, 1, monthDays);
+    }
+    sel->onClosed = OnClosed;
+}
+
+void
+Fabric(void *p)
+{
+    date = rtc.GetDate();
+    if (date.month < 1 || date.month > 12) {
+        date.month = 1;
+    }
+    if (date.day < 1) {
+        date.day = 1;
+    }
+    field = FIELD_YEAR;
+    FieldFabric(p);
+    Menu::returnPos = Menu::FindAction(SetupMenu::actions, Fabric);
+}
+
+} /* namespace SetupDate */
+
+
+namespace SetupLighting {
+
+void
+OnClosed(u16)
+{
+    light.SetTargetIntegral(static_cast<TPage *>(app.CurPage())->GetValue());
+    app.SetNextPage(Application::GetPageTypeCode<Menu>(), SetupMenu::Fabric);
+}
+
+/** Show integral accumulated today as hint. */
+void
+Poll()
+{
+    static_cast<TPage *>(app.CurPage())->SetHint(light.GetLightIntegral());
+}
+
+void
+Fabric(void *p)
+{
+    TPage *sel = new (p) TPage(strings.LightingTarget,
+                               light.GetTargetIntegral(), 0, 3000);
+    Menu::returnPos = Menu::FindAction(SetupMenu::actions, Fabric);
+    sel->onClosed = OnClosed;
+    sel->poll = Poll;
+}
+
+} /* namespace SetupLighting */
+
+
+namespace SetupNutrients {
+
+enum Field {
+    FIELD_EC_MIN,
+    FIELD_EC_MAX,
+    FIELD_PH_MIN,
+    FIELD_PH_MAX
+};
+
+/** Limits being edited, fields are selected one by one. */
+static u16 limits[4];
+static u8 field;
+
+void
+FieldFabric(void *p);
+
+void
+OnClosed(u16 value)
+{
+    limits[field] = value;
+    if (field == FIELD_PH_MAX) {
+        nutrients.SetLimits(Nutrients::PROBE_EC, limits[FIELD_EC_MIN],
+                            limits[FIELD_EC_MAX]);
+        nutrients.SetLimits(Nutrients::PROBE_PH, limits[FIELD_PH_MIN],
+                            limits[FIELD_PH_MAX]);
+        app.SetNextPage(Application::GetPageTypeCode<Menu>(), SetupMenu::Fabric);
+        return;
+    }
+    field++;
+    app.SetNextPage(Application::GetPageTypeCode<TPage>(), FieldFabric);
+}
+
+/** Zero maximal value disables the check. */
+void
+Printer(u16 value, char *buf)
+{
+    if (value == 0 && (field == FIELD_EC_MAX || field == FIELD_PH_MAX)) {
+        strcpy(buf, "Off");
+        return;
+    }
+    PrintNutrientValue(field < FIELD_PH_MIN ? Nutrients::PROBE_EC :
+                                              Nutrients::PROBE_PH,
+                       value, buf);
+}
+
+void
+FieldFabric(void *p)
+{
+    TPage *sel;
+    if (field == FIELD_EC_MIN) {
+        sel = new (p) TPage(strings.NutrientsEcMin, limits[field], 0,
+                            Nutrients::MAX_EC);
+    } else if (field == FIELD_EC_MAX) {
+        sel = new (p) TPage(strings.NutrientsEcMax, limits[field], 0,
+                            Nutrients::MAX_EC);
+    } else if (field == FIELD_PH_MIN) {
+        sel = new (p) TPage(strings.NutrientsPhMin, limits[field], 0,
+                            Nutrients::MAX_PH);
+    } else {
+        sel = new (p) TPage(strings.NutrientsPhMax, limits[field], 0,
+                            Nutrients::MAX_PH);
+    }
+    sel->onClosed = OnClosed;
+    sel->printer = Printer;
+}
+
+void
+Fabric(void *p)
+{
+    limits[FIELD_EC_MIN] = nutrients.GetMinLimit(Nutrients::PROBE_EC);
+    limits[FIELD_EC_MAX] = nutrients.GetMaxLimit(Nutrients::PROBE_EC);
+    limits[FIELD_PH_MIN] = nutrients.GetMinLimit(Nutrients::PROBE_PH);
+    limits[FIELD_PH_MAX] = nutrients.GetMaxLimit(Nutrients::PROBE_PH);
+    field = FIELD_EC_MIN;
+    FieldFabric(p);
+    Menu::returnPos = Menu::FindAction(SetupMenu::actions, Fabric);
+}
+
+} /* namespace SetupNutrients */
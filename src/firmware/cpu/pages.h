@@ -40,6 +40,55 @@ namespace Status_LightSensor {
     FabricB(void *p);
 }
 
+namespace Status_Temperature {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+}
+
+namespace Status_Stack {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+}
+
+namespace Status_I2c {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+}
+
+namespace Status_Nutrients {
+    using TPage = LinearValueSelector;
+
+    void
+    FabricEc(void *p);
+
+    void
+    FabricPh(void *p);
+}
+
+namespace ClbNutrients {
+    using TPage = LinearValueSelector;
+
+    /** Select calibration point for the next Fabric() call. */
+    void
+    SetPoint(u8 probe, u8 point);
+
+    void
+    Fabric(void *p);
+}
+
+namespace ClbTemperature {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+}
+
 namespace ClbLvlGauge_MinValue {
     using TPage = LinearValueSelector;
 
@@ -103,6 +152,13 @@ namespace SetupFlooding_MaxSunsetTime {
     Fabric(void *p);
 };
 
+namespace SetupFlooding_Latitude {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+};
+
 namespace SetupTime {
     using TPage = TimeSelector;
 
@@ -110,4 +166,25 @@ namespace SetupTime {
     Fabric(void *p);
 };
 
+namespace SetupDate {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+};
+
+namespace SetupLighting {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+};
+
+namespace SetupNutrients {
+    using TPage = LinearValueSelector;
+
+    void
+    Fabric(void *p);
+};
+
 #endif /* PAGES_H_ */
@@ -12,13 +12,33 @@ using namespace adk;
 
 Rtc rtc;
 
+/** Days since the year start for each month in non-leap year. */
+static const u16 monthStartDays[12] PROGMEM = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+/** First and last register address for each group. */
+static const u8 groupRanges[][2] PROGMEM = {
+    {0x00, 0x02},
+    {0x03, 0x06},
+    {0x0e, 0x0f},
+    {0x11, 0x12}
+};
+
 Rtc::Rtc()
 {
-    /* Invalid address to force synchronization on the first access. */
-    curAddr = 0x1f;
+    /* Force synchronization on the first access. */
+    curAddr = INVALID_ADDR;
     readInProgress = false;
     writeInProgress = false;
     failure = false;
+    readMask = 0;
+    subscribed = 0;
+    /* Stale alarm flags may be left from the previous run. */
+    alarmCheckPending = true;
+    for (u8 alarm = 0; alarm < NUM_ALARMS; alarm++) {
+        alarmHandlers[alarm] = nullptr;
+    }
 }
 
 void
@@ -35,7 +55,13 @@ Rtc::Initialize()
     regs.eosc = false;
 
     writeMask = 1 << 0xe;
-    readPending = true;
+    readMask = GROUP_ALL;
+    i2cBus.RegisterDevice(I2C_ADDRESS, _ResetHandler);
+
+    /* INT line is open-drain. */
+    AVR_BIT_SET8(AVR_REG_PORT(RTC_INT_PORT), RTC_INT_PIN);
+    AVR_BIT_SET8(PCICR, PCIE2);
+    AVR_BIT_SET8(PCMSK2, RTC_INT_PCINT);
 
     while (true) {
         sei();
@@ -44,11 +70,27 @@ Rtc::Initialize()
         cli();
         {
             AtomicSection as;
-            if (!readPending && !readInProgress && !writeInProgress) {
+            if (!readMask && !readInProgress && !writeInProgress) {
                 break;
             }
         }
     }
+    scheduler.ScheduleTask(_RefreshTask, REFRESH_PERIOD);
+}
+
+u16
+Rtc::_RefreshTask()
+{
+    AtomicSection as;
+    rtc.readMask |= GROUP_TIME | (rtc.subscribed & GROUP_TEMPERATURE);
+    return REFRESH_PERIOD;
+}
+
+void
+Rtc::Subscribe(u8 groups)
+{
+    AtomicSection as;
+    subscribed |= groups;
 }
 
 void
@@ -57,28 +99,128 @@ Rtc::SetSound(bool f)
     AtomicSection as;
     regs.intcn = !f;
     writeMask |= 1 << 0x0e;
+    /* INT line outputs square wave while sound is active. */
+    if (f) {
+        AVR_BIT_CLR8(PCMSK2, RTC_INT_PCINT);
+    } else if (!AVR_BIT_GET8(PCMSK2, RTC_INT_PCINT)) {
+        AVR_BIT_SET8(PCMSK2, RTC_INT_PCINT);
+        /* Line edge could be missed, check the flags explicitly. */
+        alarmCheckPending = true;
+        readMask |= ALARM_GROUPS | (subscribed & ~GROUP_TEMPERATURE);
+    }
 }
 
 i16
 Rtc::GetTemperature()
 {
     AtomicSection as;
-    return (static_cast<i16>(regs.temp_hi) << 2) | regs.temp_lo;
+    /* Integer part is signed, fraction is positive addition to it. */
+    return static_cast<i16>(regs.temp_hi) * 4 + regs.temp_lo;
 }
 
 void
 Rtc::Poll()
 {
-    AtomicSection as;
-    if (readInProgress || writeInProgress) {
+    u8 fired = 0;
+    {
+        AtomicSection as;
+        if (readInProgress || writeInProgress) {
+            return;
+        }
+        /* Handlers see the time synchronized on the alarm. */
+        if (alarmCheckPending && !(readMask & ALARM_GROUPS) && !failure) {
+            alarmCheckPending = false;
+            fired = CheckAlarms();
+        }
+        if (writeMask) {
+            StartWrite();
+        } else if (readMask) {
+            StartRead();
+        }
+    }
+    /* Handlers may re-program alarms. */
+    for (u8 alarm = 0; alarm < NUM_ALARMS; alarm++) {
+        if ((fired & (1 << alarm)) && alarmHandlers[alarm]) {
+            alarmHandlers[alarm]();
+        }
+    }
+}
+
+u8
+Rtc::CheckAlarms()
+{
+    u8 fired = 0;
+    if (regs.a1f) {
+        regs.a1f = false;
+        fired |= 1 << ALARM_1;
+    }
+    if (regs.a2f) {
+        regs.a2f = false;
+        fired |= 1 << ALARM_2;
+    }
+    if (fired) {
+        /* Releases INT line. */
+        writeMask |= 1 << 0x0f;
+    }
+    return fired;
+}
+
+void
+Rtc::HandlePinChangeInterrupt()
+{
+    if (!AVR_BIT_GET8(PCMSK2, RTC_INT_PCINT) ||
+        AVR_BIT_GET8(AVR_REG_PIN(RTC_INT_PORT), RTC_INT_PIN)) {
+
         return;
     }
-    if (writeMask) {
-        StartWrite();
-    } else if (readPending) {
-        readPending = false;
-        StartRead();
+    alarmCheckPending = true;
+    readMask |= ALARM_GROUPS | (subscribed & ~GROUP_TEMPERATURE);
+}
+
+void
+Rtc::SetAlarm(Alarm alarm, Time time, AlarmHandler handler)
+{
+    AtomicSection as;
+    u8 min = ToBcd(time.min), hour = ToBcd(time.hour);
+    if (alarm == ALARM_1) {
+        regs.alarm1_1 = ToBcd(time.sec);
+        regs.alarm1_2 = min;
+        regs.alarm1_3 = hour;
+        regs.alarm1_4 = ALARM_DAY_IGNORE;
+        regs.a1ie = true;
+        regs.a1f = false;
+        writeMask |= (1 << 0x07) | (1 << 0x08) | (1 << 0x09) | (1 << 0x0a);
+    } else {
+        /* Alarm 2 has minutes resolution. */
+        regs.alarm2_1 = min;
+        regs.alarm2_2 = hour;
+        regs.alarm2_3 = ALARM_DAY_IGNORE;
+        regs.a2ie = true;
+        regs.a2f = false;
+        writeMask |= (1 << 0x0b) | (1 << 0x0c) | (1 << 0x0d);
+    }
+    writeMask |= (1 << 0x0e) | (1 << 0x0f);
+    alarmHandlers[alarm] = handler;
+}
+
+void
+Rtc::ClearAlarm(Alarm alarm)
+{
+    AtomicSection as;
+    if (alarm == ALARM_1) {
+        regs.a1ie = false;
+    } else {
+        regs.a2ie = false;
     }
+    writeMask |= 1 << 0x0e;
+    alarmHandlers[alarm] = nullptr;
+}
+
+u8
+Rtc::ToBcd(u8 value)
+{
+    u8 tens = value / 10;
+    return (tens << 4) | (value - tens * 10);
 }
 
 void
@@ -87,18 +229,39 @@ Rtc::StartWrite()
     writeInProgress = true;
     curAddr = 0;
     NextWriteAddr();
-    i2cBus.RequestTransfer(I2C_ADDRESS, true, _TransferHandler);
+    i2cBus.RequestTransfer(I2C_ADDRESS, true, _TransferHandler,
+                           I2cBus::Priority::PRIORITY_HIGH);
 }
 
 void
 Rtc::StartRead()
 {
+    u8 firstAddr = 0, lastAddr = 0;
+    bool found = false;
+    for (u8 group = 0; group < NUM_GROUPS; group++) {
+        if (!(readMask & (1 << group))) {
+            continue;
+        }
+        u8 start = pgm_read_byte(&groupRanges[group][0]);
+        if (!found) {
+            firstAddr = start;
+            found = true;
+        } else if (start > lastAddr + 1 + MAX_MERGE_GAP) {
+            break;
+        }
+        lastAddr = pgm_read_byte(&groupRanges[group][1]);
+        readMask &= ~(1 << group);
+    }
+    readEnd = lastAddr;
+    timeRead = firstAddr == 0;
+
     readInProgress = true;
-    if (curAddr != 0) {
+    if (curAddr != firstAddr) {
         addrTransferPending = true;
-        curAddr = 0;
+        curAddr = firstAddr;
     }
-    i2cBus.RequestTransfer(I2C_ADDRESS, addrTransferPending, _TransferHandler);
+    i2cBus.RequestTransfer(I2C_ADDRESS, addrTransferPending, _TransferHandler,
+                           I2cBus::Priority::PRIORITY_HIGH);
 }
 
 bool
@@ -118,33 +281,39 @@ Rtc::TransferHandler(I2cBus::TransferStatus status, u8 data)
                 i2cBus.RequestInstantTransfer(I2C_ADDRESS, false, _TransferHandler);
                 addrTransferPending = false;
             } else {
-                readInProgress = false;
-                failure = true;
+                TransferFailed();
                 return false;
             }
         } else {
             if (status == I2cBus::TransferStatus::RECEIVE_READY) {
-                /* Do nothing */
+                if (curAddr == readEnd) {
+                    i2cBus.Nack();
+                }
             } else if (status == I2cBus::TransferStatus::BYTE_RECEIVED) {
                 /* Do not overwrite pending write bytes. */
                 if (curAddr >= 0x10 || !(writeMask & (1 << curAddr))) {
                     reinterpret_cast<u8 *>(&regs)[curAddr] = data;
                 }
                 curAddr++;
-                if (curAddr == 0x12) {
+                if (curAddr == readEnd) {
                     i2cBus.Nack();
                 }
             } else if (status == I2cBus::TransferStatus::LAST_BYTE_RECEIVED) {
-                reinterpret_cast<u8 *>(&regs)[curAddr] = data;
+                if (curAddr >= 0x10 || !(writeMask & (1 << curAddr))) {
+                    reinterpret_cast<u8 *>(&regs)[curAddr] = data;
+                }
                 curAddr++;
-                if (curAddr > 0x12) {
+                if (curAddr > LAST_ADDR) {
                     curAddr = 0;
                 }
                 readInProgress = false;
+                failure = false;
+                if (timeRead) {
+                    wallClock.Sync(GetChipTime());
+                }
                 return false;
             } else {
-                readInProgress = false;
-                failure = true;
+                TransferFailed();
                 return false;
             }
         }
@@ -162,11 +331,11 @@ Rtc::TransferHandler(I2cBus::TransferStatus status, u8 data)
                 }
             } else {
                 writeInProgress = false;
+                failure = false;
                 return false;
             }
         } else {
-            writeInProgress = false;
-            failure = true;
+            TransferFailed();
             return false;
         }
     } else {
@@ -175,8 +344,30 @@ Rtc::TransferHandler(I2cBus::TransferStatus status, u8 data)
     return true;
 }
 
+void
+Rtc::TransferFailed()
+{
+    readInProgress = false;
+    writeInProgress = false;
+    failure = true;
+    curAddr = INVALID_ADDR;
+}
+
+void
+Rtc::_ResetHandler()
+{
+    /* Aborted transfer was already failed, just refresh the image. */
+    rtc.readMask = GROUP_ALL;
+}
+
 Rtc::Time
 Rtc::GetTime()
+{
+    return wallClock.GetTime();
+}
+
+Rtc::Time
+Rtc::GetChipTime()
 {
     AtomicSection as;
     u8 hour = regs.hour_lo;
@@ -226,6 +417,7 @@ Rtc::SetTime(Time time)
     regs.sec_lo = sec;
 
     writeMask |= (1 << 0x00) | (1 << 0x01) | (1 << 0x02);
+    wallClock.Sync(time);
 }
 
 u8
@@ -234,11 +426,61 @@ Rtc::GetDayOfWeek()
     return regs.dow;
 }
 
+Rtc::Date
+Rtc::GetDate()
+{
+    AtomicSection as;
+    return Date { static_cast<u8>(regs.date_hi * 10 + regs.date_lo),
+                  static_cast<u8>(regs.month_hi * 10 + regs.month_lo),
+                  static_cast<u8>(regs.year_hi * 10 + regs.year_lo) };
+}
+
+void
+Rtc::SetDate(Date date)
+{
+    AtomicSection as;
+    regs.date_hi = date.day / 10;
+    regs.date_lo = date.day - regs.date_hi * 10;
+    regs.month_hi = date.month / 10;
+    regs.month_lo = date.month - regs.month_hi * 10;
+    regs.century = 0;
+    regs.year_hi = date.year / 10;
+    regs.year_lo = date.year - regs.year_hi * 10;
+    writeMask |= (1 << 0x04) | (1 << 0x05) | (1 << 0x06);
+}
+
+u8
+Rtc::Date::GetMonthDays() const
+{
+    if (month < 1 || month >= 12) {
+        return 31;
+    }
+    u8 days = pgm_read_word(&monthStartDays[month]) -
+        pgm_read_word(&monthStartDays[month - 1]);
+    if (month == 2 && IsLeapYear()) {
+        days++;
+    }
+    return days;
+}
+
+u16
+Rtc::Date::GetDayOfYear() const
+{
+    if (month < 1 || month > 12 || day < 1) {
+        return 0;
+    }
+    u16 days = pgm_read_word(&monthStartDays[month - 1]) + day - 1;
+    if (month > 2 && IsLeapYear()) {
+        days++;
+    }
+    return days;
+}
+
 void
 Rtc::Update()
 {
     AtomicSection as;
-    readPending = true;
+    readMask |= subscribed & ~GROUP_TEMPERATURE;
 }
 
 bool
@@ -17,6 +17,54 @@ public:
         I2C_ADDRESS = 0b1101000
     };
 
+    /** Hardware alarms of the chip. */
+    enum Alarm {
+        ALARM_1,
+        ALARM_2,
+
+        NUM_ALARMS
+    };
+
+    struct Date {
+        /** Day of month starting from 1. */
+        u8 day,
+        /** Month starting from 1. */
+           month,
+        /** Years since 2000. */
+           year;
+
+        bool
+        IsLeapYear() const
+        {
+            return (year & 3) == 0;
+        }
+
+        /** Number of days in the month. */
+        u8
+        GetMonthDays() const;
+
+        /** Zero-based day of year. */
+        u16
+        GetDayOfYear() const;
+    };
+
+    /** Register groups which can be read separately. */
+    enum Group {
+        /** Seconds, minutes, hours. */
+        GROUP_TIME = 1 << 0,
+        /** Day of week, date, month, year. */
+        GROUP_DATE = 1 << 1,
+        /** Control and status registers. */
+        GROUP_STATUS = 1 << 2,
+        /** Temperature registers. */
+        GROUP_TEMPERATURE = 1 << 3,
+
+        GROUP_ALL = GROUP_TIME | GROUP_DATE | GROUP_STATUS | GROUP_TEMPERATURE
+    };
+
+    /** Called from poll function when alarm is fired. */
+    typedef void (*AlarmHandler)();
+
     struct Time {
         u8 hour, min, sec;
 
@@ -35,10 +83,21 @@ public:
     void
     Poll();
 
-    /** Update cached values. */
+    /** Subscribe for register groups. Subscribed groups are refreshed on
+     * Update() call and on alarm, temperature group is refreshed with the chip
+     * conversion period instead. Time group is always refreshed with the same
+     * period to synchronize the wall clock.
+     *
+     * @param groups Bit-mask of groups, see Group enum.
+     */
+    void
+    Subscribe(u8 groups);
+
+    /** Update cached values of subscribed groups. */
     void
     Update();
 
+    /** Get current time from the wall clock. Does not access the chip. */
     Time
     GetTime();
 
@@ -59,7 +118,54 @@ public:
     u8
     GetDayOfWeek();
 
+    Date
+    GetDate();
+
+    void
+    SetDate(Date date);
+
+    /** Program alarm to fire daily at the specified time. The chip pulls INT
+     * line which wakes up the MCU, the handler is called from the poll
+     * function once the flags are fetched. Any previous setting of the alarm
+     * is replaced. While sound is active the line outputs square wave so the
+     * alarm is delivered after the sound is stopped.
+     *
+     * @param alarm Alarm to use.
+     * @param time Time of day to fire at.
+     * @param handler Handler to call.
+     */
+    void
+    SetAlarm(Alarm alarm, Time time, AlarmHandler handler);
+
+    /** Disable the alarm. */
+    void
+    ClearAlarm(Alarm alarm);
+
+    /** Should be called from pin change interrupt for INT line. */
+    void
+    HandlePinChangeInterrupt();
+
 private:
+    enum {
+        /** Invalid address to force address transfer on the next read. */
+        INVALID_ADDR = 0x1f,
+        /** Alarm mask bit in the last alarm register - day is ignored. */
+        ALARM_DAY_IGNORE = 0x80,
+        /** Last readable register address. */
+        LAST_ADDR = 0x12,
+        NUM_GROUPS = 4,
+        /** Gap between groups which is still read in one burst. Re-addressing
+         * costs three bytes on the bus.
+         */
+        MAX_MERGE_GAP = 2,
+        /** Temperature conversion period of the chip, wall clock is
+         * synchronized with the same period.
+         */
+        REFRESH_PERIOD = TASK_DELAY_S(64),
+        /** Groups always read on alarm. */
+        ALARM_GROUPS = GROUP_TIME | GROUP_STATUS
+    };
+
     /** Image of the chip registers. */
     struct Registers {
         u8  sec_lo:4,           /* 0x00 */
@@ -91,7 +197,9 @@ private:
             year_lo:4,          /* 0x06 */
             year_hi:4,
 
-            /* Alarms are not used so the fields are not detailed. */
+            /* Alarm fields are BCD values with mask bit in MSB, accessed as
+             * raw bytes, see SetAlarm().
+             */
             alarm1_1:8,         /* 0x07 */
             alarm1_2:8,         /* 0x08 */
             alarm1_3:8,         /* 0x09 */
@@ -131,31 +239,74 @@ private:
 
     /** Current address in the RTC. */
     u8 curAddr:5,
-    /** Full image read is pending. */
-       readPending:1,
        readInProgress:1,
-       writeInProgress:1;
+       writeInProgress:1,
+       :1;
+    /** Last address of the current burst read. */
+    u8 readEnd:5,
+    /** Current burst includes time group. */
+       timeRead:1,
+       :2;
+    /** Groups pending for read. */
+    u8 readMask:4,
+    /** Groups refreshed on update. */
+       subscribed:4;
     /** Temperature value from last read. */
     u16 temperature:10,
     /** Current address must be transferred before data reading. */
         addrTransferPending:1,
         failure:1,
-        :4;
+    /** Alarm flags should be checked after the next read. */
+        alarmCheckPending:1,
+        :3;
 
     Registers regs;
+    AlarmHandler alarmHandlers[NUM_ALARMS];
 
     void
     StartWrite();
 
+    /** Start burst read of pending groups which are close enough to each
+     * other.
+     */
     void
     StartRead();
 
+    /** Request periodic groups read. */
+    static u16
+    _RefreshTask();
+
+    /** Get time from the registers image. */
+    Time
+    GetChipTime();
+
     static bool
     _TransferHandler(I2cBus::TransferStatus status, u8 data);
 
     bool
     TransferHandler(I2cBus::TransferStatus status, u8 data);
 
+    /** Terminate current transfer on failure. Address pointer in the chip is
+     * unknown after that.
+     */
+    void
+    TransferFailed();
+
+    /** Bus fault recovery handler. */
+    static void
+    _ResetHandler();
+
+    /** Check and clear alarm flags in the registers image.
+     *
+     * @return Bit-mask of fired alarms.
+     */
+    u8
+    CheckAlarms();
+
+    /** Convert value to BCD representation. */
+    static u8
+    ToBcd(u8 value);
+
     /** Set current address to next pending byte in write mask.
      *
      * @return True if address is not consequential.
@@ -0,0 +1,155 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file solar.cpp
+ * Sunrise hour angle is found from cos(H) = -tan(lat) * tan(decl). All
+ * trigonometry is evaluated at compile time into small fixed-point tables.
+ */
+
+#include "cpu.h"
+
+using namespace adk;
+
+namespace {
+
+namespace solar_gen {
+
+enum {
+    /** Fractional bits for tangent values. */
+    TAN_BITS = 13,
+    TAN_ONE = 1 << TAN_BITS,
+    /** Step of declination table, days. */
+    DECL_STEP = 8,
+    /** One more entry for interpolation of the last days. */
+    DECL_SIZE = 365 / DECL_STEP + 2,
+    /** Number of bits for the hour angle table index. */
+    HALF_DAY_BITS = 6,
+    HALF_DAY_SIZE = (1 << HALF_DAY_BITS) + 1,
+    /** Bits of interpolation fraction in hour angle table argument. */
+    HALF_DAY_FRAC_BITS = TAN_BITS + 1 - HALF_DAY_BITS
+};
+
+constexpr double PI = 3.14159265358979;
+/** Earth axial tilt, degrees. */
+constexpr double AXIAL_TILT = 23.44;
+
+constexpr i16
+Round(double x)
+{
+    return static_cast<i16>(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+/** Tangent of the Sun declination for the specified day of year. Day 0 is
+ * January 1, winter solstice is ten days before.
+ */
+constexpr i16
+TanDecl(u16 day)
+{
+    return Round(__builtin_tan(-AXIAL_TILT * PI / 180 *
+                               __builtin_cos(2 * PI * (day + 10) / 365)) *
+                 TAN_ONE);
+}
+
+constexpr i16
+TanLat(u16 lat)
+{
+    return Round(__builtin_tan(lat * PI / 180) * TAN_ONE);
+}
+
+/** Half of daylight duration in minutes for table index which maps to
+ * cos(H) in range [-1; 1].
+ */
+constexpr i16
+HalfDay(u16 idx)
+{
+    return Round(__builtin_acos(-1.0 + 2.0 * idx / (HALF_DAY_SIZE - 1)) / PI *
+                 12 * 60);
+}
+
+template <class TSeq>
+struct DeclTable;
+
+template <u16... n>
+struct DeclTable<meta::IndexSeq<n...>> {
+    static const i16 data[sizeof...(n)];
+};
+
+template <u16... n>
+const i16 DeclTable<meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { TanDecl(n * DECL_STEP)... };
+
+template <class TSeq>
+struct LatTable;
+
+template <u16... n>
+struct LatTable<meta::IndexSeq<n...>> {
+    static const i16 data[sizeof...(n)];
+};
+
+template <u16... n>
+const i16 LatTable<meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { TanLat(n)... };
+
+template <class TSeq>
+struct HalfDayTable;
+
+template <u16... n>
+struct HalfDayTable<meta::IndexSeq<n...>> {
+    static const i16 data[sizeof...(n)];
+};
+
+template <u16... n>
+const i16 HalfDayTable<meta::IndexSeq<n...>>::data[sizeof...(n)] PROGMEM =
+    { HalfDay(n)... };
+
+using Decl = DeclTable<meta::MakeIndexSeq<DECL_SIZE>::Type>;
+using Lat = LatTable<meta::MakeIndexSeq<solar::MAX_LATITUDE + 1>::Type>;
+using HalfDays = HalfDayTable<meta::MakeIndexSeq<HALF_DAY_SIZE>::Type>;
+
+} /* namespace solar_gen */
+
+} /* anonymous namespace */
+
+u16
+solar::GetDayLength(u16 dayOfYear, i8 latitude)
+{
+    using namespace solar_gen;
+
+    u8 lat = latitude < 0 ? -latitude : latitude;
+    if (lat > MAX_LATITUDE) {
+        lat = MAX_LATITUDE;
+    }
+    if (dayOfYear > 365) {
+        dayOfYear = 365;
+    }
+
+    u8 idx = dayOfYear / DECL_STEP;
+    i16 d0 = pgm_read_word(&Decl::data[idx]);
+    i16 d1 = pgm_read_word(&Decl::data[idx + 1]);
+    i16 tanDecl = d0 + (d1 - d0) * static_cast<i16>(dayOfYear % DECL_STEP) /
+        DECL_STEP;
+
+    i32 cosH = -((static_cast<i32>(tanDecl) *
+                  static_cast<i16>(pgm_read_word(&Lat::data[lat]))) >> TAN_BITS);
+    if (latitude < 0) {
+        cosH = -cosH;
+    }
+    /* Polar day or night. */
+    if (cosH <= -TAN_ONE) {
+        return 24 * 60;
+    }
+    if (cosH >= TAN_ONE) {
+        return 0;
+    }
+
+    u16 arg = cosH + TAN_ONE;
+    idx = arg >> HALF_DAY_FRAC_BITS;
+    i16 h0 = pgm_read_word(&HalfDays::data[idx]);
+    i16 h1 = pgm_read_word(&HalfDays::data[idx + 1]);
+    i16 frac = arg & ((1 << HALF_DAY_FRAC_BITS) - 1);
+    i16 halfDay = h0 + ((static_cast<i32>(h1 - h0) * frac) >> HALF_DAY_FRAC_BITS);
+    return halfDay * 2;
+}
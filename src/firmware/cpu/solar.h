@@ -0,0 +1,35 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file solar.h
+ * Daylight duration estimation by day of year and latitude.
+ */
+
+#ifndef SOLAR_H_
+#define SOLAR_H_
+
+namespace solar {
+
+enum {
+    /** Maximal absolute latitude supported, degrees. Polar day and night
+     * are handled by clamping so higher values are just limited.
+     */
+    MAX_LATITUDE = 66
+};
+
+/** Get daylight duration. Atmospheric refraction and the Sun disc size are
+ * not accounted so the result is few minutes shorter than the real one.
+ *
+ * @param dayOfYear Zero-based day of year.
+ * @param latitude Latitude in degrees, positive for northern hemisphere.
+ * @return Daylight duration in minutes.
+ */
+u16
+GetDayLength(u16 dayOfYear, i8 latitude);
+
+} /* namespace solar */
+
+#endif /* SOLAR_H_ */
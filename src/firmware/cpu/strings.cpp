@@ -22,3 +22,21 @@ Strings::StrClockNum(u8 value, char *buf)
     buf[1] = '0' + value;
     buf[2] = 0;
 }
+
+void
+Strings::StrTemperature(i16 temp, char *buf)
+{
+    u8 len = 0;
+    if (temp < 0) {
+        buf[len++] = '-';
+        temp = -temp;
+    }
+    itoa(temp >> 2, buf + len, 10);
+    len = strlen(buf);
+    buf[len] = '.';
+    u8 frac = temp & 3;
+    buf[len + 1] = '0' + ((10 * frac + 2) >> 2);
+    buf[len + 2] = 0x10;
+    buf[len + 3] = 'C';
+    buf[len + 4] = 0;
+}
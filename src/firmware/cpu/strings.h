@@ -15,6 +15,60 @@
 #define DEF_STR(__name, __text) \
     const char __name[sizeof(__text)] = __text;
 
+/** Menu items strings with items offsets precomputed at compile time. */
+template <u8 numItems, u16 size>
+struct MenuItems {
+    /** Offset of each item in the text. */
+    u8 offsets[numItems];
+    /** Null-terminated items, additional null terminator after last item. */
+    char text[size];
+} __PACKED;
+
+namespace menu_gen {
+
+/** Number of items in menu text of the specified length (not including the
+ * final terminator).
+ */
+constexpr u8
+NumItems(const char *text, u16 len, u16 pos = 0)
+{
+    return pos >= len ? 0 : (text[pos] ? 0 : 1) + NumItems(text, len, pos + 1);
+}
+
+constexpr u8
+ItemOffset(const char *text, u8 idx, u16 pos = 0)
+{
+    return idx == 0 ? pos :
+        ItemOffset(text, text[pos] ? idx : idx - 1, pos + 1);
+}
+
+template <u8 numItems, u16 size, u16... itemIdx, u16... charIdx>
+constexpr MenuItems<numItems, size>
+Make(const char *text, meta::IndexSeq<itemIdx...>, meta::IndexSeq<charIdx...>)
+{
+    return MenuItems<numItems, size> {
+        { ItemOffset(text, itemIdx)... },
+        { text[charIdx]... }
+    };
+}
+
+} /* namespace menu_gen */
+
+/** Define menu items string for placing in program memory.
+ * @param __name Name for accessing.
+ * @param __text Items separated by null characters, additional null terminator
+ *      after the last item.
+ */
+#define DEF_MENU(__name, __text) \
+    static_assert(sizeof(__text) <= 256, "Menu text too long"); \
+    const MenuItems<menu_gen::NumItems(__text, sizeof(__text) - 1), \
+                    sizeof(__text)> __name = \
+        menu_gen::Make<menu_gen::NumItems(__text, sizeof(__text) - 1), \
+                       sizeof(__text)>( \
+            __text, \
+            meta::MakeIndexSeq<menu_gen::NumItems(__text, sizeof(__text) - 1)>::Type(), \
+            meta::MakeIndexSeq<sizeof(__text)>::Type());
+
 class Strings {
 public:
     /** Convert number to string. Applicable to time number only (two digits,
@@ -23,6 +77,14 @@ public:
     static void
     StrClockNum(u8 value, char *buf);
 
+    /** Convert temperature to string with one decimal digit and degree sign.
+     *
+     * @param temp Temperature, fixed point with two fractional bits.
+     * @param buf Buffer for at least 9 characters.
+     */
+    static void
+    StrTemperature(i16 temp, char *buf);
+
     DEF_STR(NoValue, "<no value>")
     DEF_STR(OK, "OK")
     DEF_STR(Cancel, "Cancel")
@@ -34,6 +96,10 @@ public:
     DEF_STR(LvlGaugeClbMax, "Level gauge max.")
     DEF_STR(LightSensorA, "Light sensor A")
     DEF_STR(LightSensorB, "Light sensor B")
+    DEF_STR(StackStatus, "Free stack")
+    DEF_STR(I2cStatus, "I2C bus faults")
+    DEF_STR(TemperatureStatus, "Temperature")
+    DEF_STR(TemperatureClb, "Int. sensor offset")
     DEF_STR(FloodingPumpThrottle, "Pump throttle")
     DEF_STR(FloodingPumpBoostThrottle, "Pump boost throttle")
     DEF_STR(FloodingMinSunriseTime, "Min. sunrise time")
@@ -41,7 +107,20 @@ public:
     DEF_STR(FloodingFloodDuration, "Flooding duration")
     DEF_STR(FloodingFloodPeriod, "Flooding period")
     DEF_STR(FloodingMaxSunsetTime, "Max. sunset time")
+    DEF_STR(FloodingLatitude, "Latitude")
+    DEF_STR(LightingTarget, "Daily light target")
+    DEF_STR(NutrientsEc, "Conductivity")
+    DEF_STR(NutrientsPh, "Acidity")
+    DEF_STR(NutrientsEcClb, "EC calibration")
+    DEF_STR(NutrientsPhClb, "pH calibration")
+    DEF_STR(NutrientsEcMin, "Min. EC")
+    DEF_STR(NutrientsEcMax, "Max. EC")
+    DEF_STR(NutrientsPhMin, "Min. pH")
+    DEF_STR(NutrientsPhMax, "Max. pH")
     DEF_STR(TimeSetup, "Setup time")
+    DEF_STR(DateSetupYear, "Setup year")
+    DEF_STR(DateSetupMonth, "Setup month")
+    DEF_STR(DateSetupDay, "Setup day")
 
     DEF_STR(FlooderStatus_Idle, "Idle")
     DEF_STR(FlooderStatus_Flooding, "Flooding")
@@ -51,46 +130,61 @@ public:
     DEF_STR(FlooderStatus_Failure, "Failure")
 
     DEF_STR(FlooderError_LowWater, "Too low water for flooding")
+    DEF_STR(FlooderError_NutrientsRange, "Nutrients out of range")
 
     /* Menus */
-    DEF_STR(MainMenu,
+    DEF_MENU(MainMenu,
             "Return\0"
             "Manual control\0"
             "Calibration\0"
             "Setup\0"
             "Status\0")
 
-    DEF_STR(ManualControlMenu,
+    DEF_MENU(ManualControlMenu,
             "Return\0"
             "Light\0"
             "Pump\0"
             "Start flooding\0")
 
-    DEF_STR(CalibrationMenu,
+    DEF_MENU(CalibrationMenu,
             "Return\0"
             "Light\0"
             "Level gauge\0"
-            "Temperature\0")
+            "Temperature\0"
+            "EC probe\0"
+            "pH probe\0")
 
-    DEF_STR(SetupMenu,
+    DEF_MENU(SetupMenu,
             "Return\0"
             "Time\0"
+            "Date\0"
             "Flooding\0"
-            "Lighting\0")
+            "Lighting\0"
+            "Nutrients\0")
 
-    DEF_STR(StatusMenu,
+    DEF_MENU(StatusMenu,
             "Return\0"
             "Level gauge\0"
             "Light sensor A\0"
             "Light sensor B\0"
-            "Temperature\0")
+            "Temperature\0"
+            "Stack\0"
+            "I2C bus\0"
+            "EC\0"
+            "pH\0")
 
-    DEF_STR(LvlGaugeCalibrationMenu,
+    DEF_MENU(LvlGaugeCalibrationMenu,
             "Return\0"
             "Min. value\0"
             "Max. value\0")
 
-    DEF_STR(FloodingSetupMenu,
+    DEF_MENU(ProbeCalibrationMenu,
+            "Return\0"
+            "Point 1\0"
+            "Point 2\0"
+            "Point 3\0")
+
+    DEF_MENU(FloodingSetupMenu,
             "Return\0"
             "Pump throttle\0"
             "Pump boost throttle\0"
@@ -98,7 +192,8 @@ public:
             "First flood delay\0"
             "Flood duration\0"
             "Flood period\0"
-            "Max. sunset time\0")
+            "Max. sunset time\0"
+            "Latitude\0")
 
 } __PACKED;
 
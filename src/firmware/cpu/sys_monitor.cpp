@@ -0,0 +1,94 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file sys_monitor.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+/** Linker provided symbols. End of static data and initial stack top. */
+extern u8 _end, __stack;
+
+SysMonitor sysMonitor;
+
+/** Paint all RAM above static data with canary pattern. Executed before stack
+ * pointer is initialized so no stack usage is allowed here.
+ */
+static void
+StackPaint() __attribute__((naked, used, section(".init1")));
+
+static void
+StackPaint()
+{
+    __asm volatile (
+        "    ldi r30, lo8(_end)\n"
+        "    ldi r31, hi8(_end)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(__stack)\n"
+        "    rjmp 2f\n"
+        "1:\n"
+        "    st Z+, r24\n"
+        "2:\n"
+        "    cpi r30, lo8(__stack)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :: "M" (SysMonitor::STACK_CANARY));
+}
+
+SysMonitor::SysMonitor()
+{
+    lowStackReported = false;
+}
+
+void
+SysMonitor::Initialize()
+{
+    minFreeStack = GetCurFreeStack();
+    scheduler.ScheduleTask(_ScanTask, SCAN_PERIOD);
+}
+
+u16
+SysMonitor::GetCurFreeStack()
+{
+    AtomicSection as;
+    return SP - reinterpret_cast<uintptr_t>(&_end);
+}
+
+u16
+SysMonitor::GetTotalStack()
+{
+    return reinterpret_cast<uintptr_t>(&__stack) -
+        reinterpret_cast<uintptr_t>(&_end) + 1;
+}
+
+u16
+SysMonitor::_ScanTask()
+{
+    return sysMonitor.ScanTask();
+}
+
+u16
+SysMonitor::ScanTask()
+{
+    /* High-water mark only moves down so the scan never goes above the
+     * previous one.
+     */
+    const u8 *p = &_end;
+    u16 n = 0;
+    while (n < minFreeStack && *p == STACK_CANARY) {
+        p++;
+        n++;
+    }
+    minFreeStack = n;
+
+    if (n < CRITICAL_FREE_STACK && !lowStackReported) {
+        lowStackReported = true;
+        led.SetMode(Led::Mode::FAILURE);
+    }
+    return SCAN_PERIOD;
+}
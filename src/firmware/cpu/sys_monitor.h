@@ -0,0 +1,67 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file sys_monitor.h
+ * Run-time monitoring of RAM usage.
+ */
+
+#ifndef SYS_MONITOR_H_
+#define SYS_MONITOR_H_
+
+/** Tracks stack usage. Unused RAM between static data
+ * and stack is painted with canary pattern at boot, the painted area is
+ * periodically scanned to find the stack high-water mark.
+ */
+class SysMonitor {
+public:
+    enum {
+        /** Pattern which unused RAM is painted with. */
+        STACK_CANARY = 0xc5,
+        /** Free stack amount considered critical, bytes. */
+        CRITICAL_FREE_STACK = 16
+    };
+
+    SysMonitor();
+
+    void
+    Initialize();
+
+    /** Minimal amount of free stack space seen since boot, bytes. */
+    u16
+    GetMinFreeStack()
+    {
+        return minFreeStack;
+    }
+
+    /** Current amount of free space between static data and stack top. */
+    u16
+    GetCurFreeStack();
+
+    /** Total amount of RAM available for stack, bytes. */
+    u16
+    GetTotalStack();
+
+private:
+    enum {
+        SCAN_PERIOD = TASK_DELAY_S(1)
+    };
+
+    /** Stack high-water mark, bytes left untouched. */
+    u16 minFreeStack;
+    /** Low stack space already reported. */
+    u8 lowStackReported:1,
+       :7;
+
+    static u16
+    _ScanTask();
+
+    u16
+    ScanTask();
+} __PACKED;
+
+extern SysMonitor sysMonitor;
+
+#endif /* SYS_MONITOR_H_ */
@@ -0,0 +1,85 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file temp_monitor.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+TempMonitor tempMonitor;
+
+/* Typical sensor output is 1mV/C with 289mV at 0C, 1.1V reference gives
+ * 1.074mV per ADC unit.
+ */
+u16 EEMEM TempMonitor::eeCalOffset = 269;
+u8 EEMEM TempMonitor::eeCalFactor = 137;
+
+void
+TempMonitor::Enable()
+{
+    calOffset = eeprom_read_word(&eeCalOffset);
+    calFactor = eeprom_read_byte(&eeCalFactor);
+    accumulated = 0;
+    curTemp = 0;
+    curInternalTemp = 0;
+    curInternalRaw = 0;
+    sensorsDisagree = false;
+    measured = false;
+    adc.SetOversampling(Adc::TEMPERATURE_CHANNEL, SENSOR_OVERSAMPLING);
+    rtc.Subscribe(Rtc::GROUP_TEMPERATURE);
+    scheduler.ScheduleTask(PeriodicTask, FIRST_MEASUREMENT_DELAY);
+}
+
+void
+TempMonitor::SetCalibration(u16 offset, u8 factor)
+{
+    eeprom_update_word(&eeCalOffset, offset);
+    eeprom_update_byte(&eeCalFactor, factor);
+    AtomicSection as;
+    calOffset = offset;
+    calFactor = factor;
+}
+
+u16
+TempMonitor::PeriodicTask()
+{
+    /* Result of the previous conversion is available now. */
+    if (tempMonitor.measured) {
+        tempMonitor.Update();
+        adc.ScheduleConversion(Adc::TEMPERATURE_CHANNEL);
+        return MEASUREMENT_PERIOD;
+    }
+    /* Get the first reading shortly after start-up. */
+    tempMonitor.measured = true;
+    adc.ScheduleConversion(Adc::TEMPERATURE_CHANNEL);
+    return FIRST_MEASUREMENT_DELAY;
+}
+
+void
+TempMonitor::Update()
+{
+    u16 value = adc.GetSample(Adc::TEMPERATURE_CHANNEL).value;
+    i16 rtcTemp = rtc.GetTemperature();
+
+    AtomicSection as;
+    curInternalRaw = value >> SENSOR_OVERSAMPLING;
+    /* Oversampled value has two fractional bits, same as the result. */
+    curInternalTemp = (static_cast<i32>(value) -
+        (static_cast<i32>(calOffset) << SENSOR_OVERSAMPLING)) * calFactor >> 7;
+
+    i16 diff = curInternalTemp - rtcTemp;
+    sensorsDisagree = diff >= DISAGREE_LEVEL || diff <= -DISAGREE_LEVEL;
+    if (sensorsDisagree) {
+        curTemp = rtcTemp;
+    } else {
+        curTemp = (curInternalTemp + rtcTemp) / 2;
+    }
+
+    if (curTemp > 0) {
+        accumulated += curTemp;
+    }
+}
@@ -0,0 +1,130 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file temp_monitor.h */
+
+#ifndef TEMP_MONITOR_H_
+#define TEMP_MONITOR_H_
+
+/** Temperature measurement by MCU internal sensor and RTC chip sensor. All
+ * temperature values are fixed point, two LSB - fractional part.
+ */
+class TempMonitor {
+public:
+    void
+    Enable();
+
+    /** Combined temperature. Average of both sensors when they agree, RTC
+     * sensor reading otherwise since it is factory calibrated.
+     */
+    i16
+    GetTemperature()
+    {
+        return curTemp;
+    }
+
+    /** Calibrated MCU internal sensor reading. */
+    i16
+    GetInternalTemperature()
+    {
+        return curInternalTemp;
+    }
+
+    /** Raw internal sensor ADC reading, can be used for calibration. */
+    u16
+    GetInternalRaw()
+    {
+        return curInternalRaw;
+    }
+
+    /** Internal sensor reading converted with the specified calibration
+     * offset and the current calibration factor.
+     *
+     * @param raw Raw ADC reading, see GetInternalRaw().
+     * @param offset Raw ADC reading which corresponds to 0C.
+     */
+    i16
+    ConvertInternal(u16 raw, u16 offset)
+    {
+        return (static_cast<i32>(raw) - offset) * 4 * calFactor >> 7;
+    }
+
+    u16
+    GetCalOffset()
+    {
+        return calOffset;
+    }
+
+    u8
+    GetCalFactor()
+    {
+        return calFactor;
+    }
+
+    /** Sensors readings differ too much, internal sensor is probably not
+     * calibrated.
+     */
+    bool
+    IsSensorsDisagree()
+    {
+        return sensorsDisagree;
+    }
+
+    /** Degree-hours above zero accumulated since launch. */
+    u16
+    GetDegreeHours()
+    {
+        return accumulated / (4 * SAMPLES_PER_HOUR);
+    }
+
+    /** Set internal sensor calibration.
+     *
+     * @param offset Raw ADC reading which corresponds to 0C.
+     * @param factor Scale factor, 0x80 is 1.0 (one ADC unit per degree),
+     *      0xff is 1.996.
+     */
+    void
+    SetCalibration(u16 offset, u8 factor);
+
+private:
+    enum {
+        MEASUREMENT_PERIOD = TASK_DELAY_S(60),
+        FIRST_MEASUREMENT_DELAY = TASK_DELAY_S(1),
+        SAMPLES_PER_HOUR = 60,
+        /** Additional internal sensor resolution bits by ADC oversampling. */
+        SENSOR_OVERSAMPLING = 2,
+        /** Sensors readings difference considered as disagreement, 1/4C. */
+        DISAGREE_LEVEL = 5 * 4
+    };
+
+    /** Accumulated samples since launch, 1/4C per sample. */
+    u32 accumulated;
+    i16 curTemp, curInternalTemp;
+    u16 curInternalRaw;
+    /** Calibration offset for 0C. */
+    u16 calOffset:10,
+        sensorsDisagree:1,
+    /** First conversion is scheduled. */
+        measured:1,
+        :4;
+    /** Calibration factor. 0x80 is 1.0, 0xff is 1.996 */
+    u8 calFactor;
+
+    static u16 EEMEM eeCalOffset;
+    static u8 EEMEM eeCalFactor;
+
+    static u16
+    PeriodicTask();
+
+    /** Process the last internal sensor conversion result. */
+    void
+    Update();
+
+} __PACKED;
+
+extern TempMonitor tempMonitor;
+
+#endif /* TEMP_MONITOR_H_ */
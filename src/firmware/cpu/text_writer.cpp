@@ -16,6 +16,15 @@ using namespace adk;
 
 TextWriter textWriter;
 
+static const Font fonts[TextWriter::FontId::NUM_FONTS] PROGMEM = {
+    /* FONT_NORMAL */
+    {&fontData[0][0], nullptr, nullptr, 0x10, SIZEOF_ARRAY(fontData),
+     FONT_WIDTH, 1, 1},
+    /* FONT_LARGE */
+    {font_gen::ScaledFont<2>::Data::data, font_gen::ScaledFont<2>::Offsets::data,
+     largeFontCharMap, 0, font_gen::NUM_CHARS, 0, 2, 2}
+};
+
 void
 TextWriter::Poll()
 {
@@ -27,7 +36,8 @@ TextWriter::Poll()
 
 void
 TextWriter::Write(Display::Viewport vp, const char *text, bool inversed,
-                  bool clear, bool fillVp, DoneHandler handler, bool isPgm)
+                  bool clear, bool fillVp, DoneHandler handler, bool isPgm,
+                  bool isStrip, FontId font)
 {
     AtomicSection as;
     /* Find queue free slot. */
@@ -54,6 +64,8 @@ TextWriter::Write(Display::Viewport vp, const char *text, bool inversed,
     req.fillVp = fillVp;
     req.handler = handler;
     req.isPgm = isPgm;
+    req.isStrip = isStrip;
+    req.font = font;
     if (idx == curReq) {
         /* Start output. */
         StartRequest();
@@ -105,7 +117,7 @@ TextWriter::OutputHandler(u8 column, u8 page, u8 *data)
                     _data = 0;
                     break;
                 }
-                NextRequest();
+                RequestDone();
                 return false;
             }
         }
@@ -124,7 +136,7 @@ TextWriter::OutputHandler(u8 column, u8 page, u8 *data)
         *data = _data;
     }
     if (page == req.vp.maxPage && column == req.vp.maxCol) {
-        NextRequest();
+        RequestDone();
     }
     return true;
 }
@@ -137,24 +149,43 @@ TextWriter::StartRequest()
         if (!req.text) {
             return false;
         }
+        if (req.isStrip) {
+            BuildStrip(req);
+            Output(req.vp, _StripOutputHandler);
+            return true;
+        }
+        if (req.font != FontId::FONT_NORMAL) {
+            memcpy_P(&curFont, &fonts[req.font], sizeof(curFont));
+            Output(req.vp, _FontOutputHandler);
+            return true;
+        }
         if (req.isPgm) {
             curChar = pgm_read_byte(req.text);
         } else {
             curChar = *req.text;
         }
-        req.text++;
         if (!curChar) {
             NextRequest();
             continue;
         }
         curCharCol = 0;
         fillingTail = false;
-        reqInProgress = true;
-        display.Output(req.vp, _OutputHandler);
+        Output(req.vp, _OutputHandler);
+        if (reqInProgress) {
+            /* First character is consumed only when the output is queued. */
+            req.text++;
+        }
         return true;
     }
 }
 
+void
+TextWriter::Output(Display::Viewport vp, Display::GraphicsProvider provider)
+{
+    /* Retried from poll if display queue is full. */
+    reqInProgress = display.Output(vp, provider);
+}
+
 void
 TextWriter::NextRequest()
 {
@@ -162,7 +193,7 @@ TextWriter::NextRequest()
         reqQueue[curReq].handler();
     }
     reqQueue[curReq].text = 0;
-    if (curReq == SIZEOF_ARRAY(reqQueue)) {
+    if (curReq == SIZEOF_ARRAY(reqQueue) - 1) {
         curReq = 0;
     } else {
         curReq++;
@@ -170,3 +201,197 @@ TextWriter::NextRequest()
     curCharCol = 0;
     reqInProgress = false;
 }
+
+void
+TextWriter::RequestDone()
+{
+    NextRequest();
+    StartRequest();
+}
+
+void
+TextWriter::BuildStrip(Request &req)
+{
+    u8 numCols = req.vp.maxCol - req.vp.minCol + 1;
+    u8 *p = strip;
+    const char *text = req.text;
+    while (numCols) {
+        u8 c = *text;
+        text++;
+        u8 n = numCols < static_cast<u8>(FONT_WIDTH) ? numCols :
+            static_cast<u8>(FONT_WIDTH);
+        if (c >= 0x10) {
+            memcpy_P(p, fontData[c - 0x10], n);
+        } else {
+            memset(p, 0, n);
+        }
+        p += n;
+        numCols -= n;
+        if (numCols) {
+            *p = 0;
+            p++;
+            numCols--;
+        }
+    }
+    if (req.inversed) {
+        for (u8 *q = strip; q < p; q++) {
+            *q = ~*q;
+        }
+    }
+}
+
+bool
+TextWriter::_StripOutputHandler(u8 column, u8, u8 *data)
+{
+    Request &req = textWriter.reqQueue[textWriter.curReq];
+    *data = textWriter.strip[column - req.vp.minCol];
+    if (column == req.vp.maxCol) {
+        textWriter.RequestDone();
+    }
+    return true;
+}
+
+bool
+TextWriter::_FontOutputHandler(u8 column, u8 page, u8 *data)
+{
+    return textWriter.FontOutputHandler(column, page, data);
+}
+
+bool
+TextWriter::FontOutputHandler(u8 column, u8 page, u8 *data)
+{
+    Request &req = reqQueue[curReq];
+    if (column == req.vp.minCol) {
+        /* Glyphs are output page by page so rescan the text from the
+         * beginning on each page.
+         */
+        fontText = req.text;
+        fontRow = page - req.vp.minPage;
+        glyphCol = 0;
+        glyphWidth = 0;
+        spaceLeft = 0;
+        glyphSeen = false;
+        lineEnded = fontRow >= curFont.numPages;
+    }
+    u8 _data = 0;
+    while (true) {
+        if (spaceLeft) {
+            spaceLeft--;
+            break;
+        }
+        if (glyphCol < glyphWidth) {
+            _data = pgm_read_byte(curFont.data + glyphOffset +
+                                  fontRow * glyphWidth + glyphCol);
+            glyphCol++;
+            break;
+        }
+        if (lineEnded) {
+            break;
+        }
+        char c;
+        if (req.isPgm) {
+            c = pgm_read_byte(fontText);
+        } else {
+            c = *fontText;
+        }
+        fontText++;
+        if (!c) {
+            lineEnded = true;
+            continue;
+        }
+        if (glyphSeen) {
+            spaceLeft = curFont.spacing;
+        }
+        glyphSeen = true;
+        LoadGlyph(c);
+    }
+    if (req.inversed) {
+        *data = ~_data;
+    } else {
+        *data = _data;
+    }
+    if (page == req.vp.maxPage && column == req.vp.maxCol) {
+        RequestDone();
+    }
+    return true;
+}
+
+void
+TextWriter::LoadGlyph(char c)
+{
+    glyphCol = 0;
+    u8 idx;
+    if (curFont.charMap) {
+        for (idx = 0; idx < curFont.numChars; idx++) {
+            if (pgm_read_byte(curFont.charMap + idx) == c) {
+                break;
+            }
+        }
+    } else {
+        idx = c - curFont.firstChar;
+    }
+    if (idx >= curFont.numChars) {
+        /* Not represented in the font. */
+        glyphWidth = 0;
+        return;
+    }
+    if (curFont.offsets) {
+        glyphOffset = pgm_read_word(&curFont.offsets[idx]);
+        glyphWidth = (pgm_read_word(&curFont.offsets[idx + 1]) - glyphOffset) /
+            curFont.numPages;
+    } else {
+        glyphWidth = curFont.width;
+        glyphOffset = static_cast<u16>(idx) * curFont.width * curFont.numPages;
+    }
+}
+
+bool
+TextField::Write(const char *text, bool inversed,
+                 TextWriter::DoneHandler handler)
+{
+    AtomicSection as;
+    if (inversed != this->inversed) {
+        this->inversed = inversed;
+        isValid = false;
+    }
+    /* Find range of changed cells. */
+    u8 first = MAX_CHARS, last = 0;
+    bool textEnded = false;
+    if (!isValid && lastColumn) {
+        u8 tailCol = column + numChars *
+            (FONT_WIDTH + TextWriter::CHAR_SPACE_WIDTH);
+        if (tailCol <= lastColumn) {
+            display.Clear(Display::Viewport{tailCol, lastColumn, page, page});
+        }
+    }
+    for (u8 i = 0; i < numChars; i++) {
+        char c = ' ';
+        if (!textEnded) {
+            if (text[i]) {
+                c = text[i];
+            } else {
+                textEnded = true;
+            }
+        }
+        if (!isValid || shown[i] != c) {
+            shown[i] = c;
+            if (first == MAX_CHARS) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    isValid = true;
+    if (first == MAX_CHARS) {
+        return false;
+    }
+    u8 minCol = column + first * (FONT_WIDTH + TextWriter::CHAR_SPACE_WIDTH);
+    u8 maxCol = column + last * (FONT_WIDTH + TextWriter::CHAR_SPACE_WIDTH) +
+        FONT_WIDTH - 1;
+    if (maxCol >= DISPLAY_COLUMNS) {
+        maxCol = DISPLAY_COLUMNS - 1;
+    }
+    textWriter.Write(Display::Viewport{minCol, maxCol, page, page},
+                     shown + first, inversed, false, false, handler, false, true);
+    return true;
+}
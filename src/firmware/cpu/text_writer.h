@@ -15,12 +15,48 @@ enum {
     FONT_WIDTH = 6
 };
 
+/** Font descriptor. Stored in program memory. */
+struct Font {
+    /** Glyphs data. Each glyph is stored page by page, glyph columns of a page
+     * are consecutive.
+     */
+    const u8 *data;
+    /** Offsets of glyphs in data array for proportional font, one additional
+     * entry in the end is total data size. Null for fixed-width font.
+     */
+    const u16 *offsets;
+    /** Characters represented by the glyphs. Null for consecutive characters
+     * starting from firstChar.
+     */
+    const char *charMap;
+    u8 firstChar,
+       numChars,
+    /** Glyph width for fixed-width font. */
+       width,
+    /** Glyph height in pages. */
+       numPages,
+    /** Number of empty columns between glyphs. */
+       spacing;
+} __PACKED;
+
+class TextField;
+
 /** Helper class for text output to graphical display. */
 class TextWriter {
 public:
     /** Called when output finished. */
     typedef void (*DoneHandler)();
 
+    /** Available fonts. */
+    enum FontId {
+        /** Base 6x8 fixed-width font. */
+        FONT_NORMAL,
+        /** Two pages high proportional font. Digits and few symbols only. */
+        FONT_LARGE,
+
+        NUM_FONTS
+    };
+
     void
     Poll();
 
@@ -47,6 +83,23 @@ public:
         Write(vp, text, inversed, false, fillVp, handler, true);
     }
 
+    /** Write single line text in the specified font. The viewport is always
+     * filled fully, the text is clipped by it.
+     */
+    inline void
+    Write(Display::Viewport vp, char *text, FontId font, bool inversed = false,
+          DoneHandler handler = nullptr)
+    {
+        Write(vp, text, inversed, false, true, handler, false, false, font);
+    }
+
+    inline void
+    Write(Display::Viewport vp, const char *text, FontId font,
+          bool inversed = false, DoneHandler handler = nullptr)
+    {
+        Write(vp, text, inversed, false, true, handler, true, false, font);
+    }
+
     /** Clear space occupied by the provided text. */
     inline void
     Clear(Display::Viewport vp, char *text, bool inversed = false,
@@ -63,10 +116,15 @@ public:
     }
 
 private:
+    friend class TextField;
+
     enum {
         MAX_REQUESTS = 8,
         /** Width in pixels of space between characters in a word. */
-        CHAR_SPACE_WIDTH = 1
+        CHAR_SPACE_WIDTH = 1,
+        /** Maximal number of characters in pre-rendered strip. */
+        MAX_STRIP_CHARS = 8,
+        STRIP_SIZE = MAX_STRIP_CHARS * (FONT_WIDTH + CHAR_SPACE_WIDTH)
     };
 
     struct Request {
@@ -77,10 +135,34 @@ private:
            inversed:1,
            fillVp:1,
            clear:1,
-           reserved:4;
+        /** Fixed cells text pre-rendered into the strip buffer. */
+           isStrip:1,
+        /** Font to use, FontId. */
+           font:2,
+           reserved:1;
     } __PACKED;
 
     Request reqQueue[MAX_REQUESTS];
+    /** Pre-rendered columns for strip request. */
+    u8 strip[STRIP_SIZE];
+
+    /** Copy of current font descriptor for non-base font request. */
+    Font curFont;
+    /** Next character in the current line. */
+    const char *fontText;
+    /** Current glyph offset in font data. */
+    u16 glyphOffset;
+    u8 glyphWidth,
+    /** Current column in the glyph. */
+       glyphCol;
+    /** Current row of pages in the text line. */
+    u8 fontRow:3,
+    /** Number of spacing columns left before current glyph. */
+       spaceLeft:3,
+    /** No more characters in the line. */
+       lineEnded:1,
+    /** At least one glyph started in the current row. */
+       glyphSeen:1;
     /** Current request index in the queue. */
     u8 curReq:3,
     /** Current column in the character. One additional column for space. */
@@ -97,7 +179,8 @@ private:
 
     void
     Write(Display::Viewport vp, const char *text, bool inversed, bool clear,
-          bool fillVp, DoneHandler handler, bool isPgm);
+          bool fillVp, DoneHandler handler, bool isPgm, bool isStrip = false,
+          FontId font = FontId::FONT_NORMAL);
 
     static bool
     _OutputHandler(u8 column, u8 page, u8 *data);
@@ -105,6 +188,27 @@ private:
     bool
     OutputHandler(u8 column, u8 page, u8 *data);
 
+    /** Render current strip request characters into strip buffer. */
+    void
+    BuildStrip(Request &req);
+
+    static bool
+    _StripOutputHandler(u8 column, u8 page, u8 *data);
+
+    static bool
+    _FontOutputHandler(u8 column, u8 page, u8 *data);
+
+    bool
+    FontOutputHandler(u8 column, u8 page, u8 *data);
+
+    /** Set current glyph for the specified character in current font. */
+    void
+    LoadGlyph(char c);
+
+    /** Queue current request output to the display. */
+    void
+    Output(Display::Viewport vp, Display::GraphicsProvider provider);
+
     /** Start current request processing.
      *
      * @return True if request pending, false if no requests queued.
@@ -115,9 +219,72 @@ private:
     void
     NextRequest();
 
+    /** Complete current request and start the next one. Called from the
+     * output handlers after the last byte is provided so that the next output
+     * is queued to the display before the current one is finished.
+     */
+    void
+    RequestDone();
+
 } __PACKED;
 
 extern TextWriter textWriter;
 
+/** Fixed-width single line text field (clock, counters etc). Remembers
+ * displayed text and redraws only changed character cells. The cells are
+ * copied from font data into a strip buffer so the output is a plain copy
+ * instead of going through generic text layout.
+ */
+class TextField {
+public:
+    enum {
+        MAX_CHARS = TextWriter::MAX_STRIP_CHARS
+    };
+
+    /** @param column Left column of the field.
+     *  @param page Display page of the field.
+     *  @param numChars Field width in characters, up to MAX_CHARS.
+     *  @param lastColumn Right column of the field region. Columns after the
+     *      characters cells are cleared on full redraw. Zero if the region
+     *      ends with the cells.
+     */
+    TextField(u8 column, u8 page, u8 numChars, u8 lastColumn = 0):
+        column(column), lastColumn(lastColumn), page(page), numChars(numChars)
+    {
+        Invalidate();
+    }
+
+    /** Update the field content.
+     *
+     * @param text Text in data memory, up to field width characters.
+     * @param inversed Inverse pixels.
+     * @param handler Handler to call when done.
+     * @return True if output was issued, false if nothing changed (handler is
+     *      not called in such case).
+     */
+    bool
+    Write(const char *text, bool inversed = false,
+          TextWriter::DoneHandler handler = nullptr);
+
+    /** Force full redraw on next write. */
+    void
+    Invalidate()
+    {
+        isValid = false;
+    }
+
+private:
+    /** Currently displayed characters, padded with spaces. */
+    char shown[MAX_CHARS];
+    u8 column, lastColumn;
+    u8 page:3,
+       isValid:1,
+       inversed:1,
+       :3,
+
+       numChars:4,
+       :4;
+} __PACKED;
+
 
 #endif /* TEXT_WRITER_H_ */
@@ -10,106 +10,96 @@
 
 using namespace adk;
 
+const DrawList::Op TimeSelector::drawOps[] PROGMEM = {
+    DrawList::CustomOp(M_TITLE,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawTitle>),
+    DrawList::CustomOp(M_CANCEL,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawCancel>),
+    DrawList::CustomOp(M_OK,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawOk>),
+    DrawList::CustomOp(M_SEP,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawSeparator>),
+    DrawList::CustomOp(M_HOUR,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawHour>),
+    DrawList::CustomOp(M_MIN,
+        DrawList::Method<TimeSelector, &TimeSelector::DrawMin>)
+};
+
 TimeSelector::TimeSelector(const char *title, Time initialValue):
+    drawList(this, drawOps, SIZEOF_ARRAY(drawOps)),
     title(title), value(initialValue)
 {
-    drawInProgress = false;
-    drawPending = false;
-    closeRequested = false;
     selection = Selection::SEL_HOUR;
-    Draw(true);
+    drawList.Invalidate(DrawMask::M_ALL);
 }
 
-void
-TimeSelector::Draw(bool full)
+bool
+TimeSelector::RequestClose()
 {
-    AtomicSection as;
-    if (closeRequested) {
-        return;
-    }
-    if (drawInProgress) {
-        drawPending = true;
-        fullDrawPending = full;
-        return;
-    }
-    drawInProgress = true;
-    drawState = full ? DrawState::FULL_DRAW : DrawState::PARTIAL_DRAW;
-    IssueDrawRequest();
+    return drawList.Close();
 }
 
-void
-TimeSelector::IssueDrawRequest()
+u8
+TimeSelector::DrawTitle()
 {
-    switch (drawState) {
-    case DrawState::TITLE:
-        textWriter.Write(Display::Viewport{0, 127, 0, 1}, title, false, false,
-                         _DrawHandler);
-        break;
-    case DrawState::CANCEL: {
-        u8 x1 = 10;
-        u8 x2 = x1 + (FONT_WIDTH + 1) * 6;
-        textWriter.Write(Display::Viewport{x1, x2, 6, 6},
-                         strings.Cancel, selection == SEL_CANCEL, false,
-                         _DrawHandler);
-        break;
-    }
-    case DrawState::OK: {
-        u8 x1 = 10 + (FONT_WIDTH + 1) * 6 + 20;
-        u8 x2 = x1 + (FONT_WIDTH + 1) * 2;
-        textWriter.Write(Display::Viewport{x1, x2, 6, 6},
-                         strings.OK, selection == SEL_OK, false, _DrawHandler);
-        break;
-    }
-    case DrawState::SEP: {
-        u8 x1 = CLOCK_COL + (FONT_WIDTH + 1) * 2;
-        u8 x2 = x1 + FONT_WIDTH + 1;
-        buf[0] = ':';
-        buf[1] = 0;
-        textWriter.Write(Display::Viewport{x1, x2, 3, 3}, buf, false, false,
-                         _DrawHandler);
-        break;
-    }
-    case DrawState::HOUR:
-        Strings::StrClockNum(value.hour, buf);
-        textWriter.Write(
-            Display::Viewport{CLOCK_COL, CLOCK_COL + (FONT_WIDTH + 1) * 2, 3, 3},
-            buf, selection == SEL_HOUR, false, _DrawHandler);
-        break;
-    case DrawState::MIN: {
-        Strings::StrClockNum(value.min, buf);
-        u8 x1 = CLOCK_COL + (FONT_WIDTH + 1) * 3;
-        u8 x2 = x1 + (FONT_WIDTH + 1) * 2;
-        textWriter.Write(Display::Viewport{x1, x2, 3, 3}, buf,
-            selection == SEL_MIN, false, _DrawHandler);
-        break;
-    }
-    }
+    textWriter.Write(Display::Viewport{0, 127, 0, 1}, title, false, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
 }
 
-void
-TimeSelector::DrawHandler()
+u8
+TimeSelector::DrawCancel()
 {
-    AtomicSection as;
+    u8 x1 = 10;
+    u8 x2 = x1 + (FONT_WIDTH + 1) * 6;
+    textWriter.Write(Display::Viewport{x1, x2, 6, 6},
+                     strings.Cancel, selection == SEL_CANCEL, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
+}
 
-    if (closeRequested ||
-        (drawPending && (fullDrawPending || drawState >= DrawState::PARTIAL_DRAW))) {
+u8
+TimeSelector::DrawOk()
+{
+    u8 x1 = 10 + (FONT_WIDTH + 1) * 6 + 20;
+    u8 x2 = x1 + (FONT_WIDTH + 1) * 2;
+    textWriter.Write(Display::Viewport{x1, x2, 6, 6},
+                     strings.OK, selection == SEL_OK, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::CONTINUE;
+}
 
-        drawInProgress = false;
-        return;
-    }
+u8
+TimeSelector::DrawSeparator()
+{
+    u8 x1 = CLOCK_COL + (FONT_WIDTH + 1) * 2;
+    u8 x2 = x1 + FONT_WIDTH + 1;
+    buf[0] = ':';
+    buf[1] = 0;
+    textWriter.Write(Display::Viewport{x1, x2, 3, 3}, buf, false, false,
+                     DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
+}
 
-    if (drawState != DrawState::LAST) {
-        drawState++;
-        IssueDrawRequest();
-        return;
-    }
-    drawInProgress = false;
+u8
+TimeSelector::DrawHour()
+{
+    Strings::StrClockNum(value.hour, buf);
+    textWriter.Write(
+        Display::Viewport{CLOCK_COL, CLOCK_COL + (FONT_WIDTH + 1) * 2, 3, 3},
+        buf, selection == SEL_HOUR, false, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
 }
 
-void
-TimeSelector::_DrawHandler()
+u8
+TimeSelector::DrawMin()
 {
-    static_cast<TimeSelector *>(app.CurPage())->DrawHandler();
+    Strings::StrClockNum(value.min, buf);
+    u8 x1 = CLOCK_COL + (FONT_WIDTH + 1) * 3;
+    u8 x2 = x1 + (FONT_WIDTH + 1) * 2;
+    textWriter.Write(Display::Viewport{x1, x2, 3, 3}, buf,
+                     selection == SEL_MIN, false, DrawList::_DoneHandler);
+    return DrawList::Result::WAIT;
 }
 
 void
@@ -118,11 +108,11 @@ TimeSelector::OnButtonPressed()
     switch (selection) {
     case SEL_HOUR:
         selection = SEL_MIN;
-        Draw();
+        drawList.Invalidate(DrawMask::M_HOUR | DrawMask::M_MIN);
         break;
     case SEL_MIN:
         selection = SEL_CANCEL;
-        Draw(true);
+        drawList.Invalidate(DrawMask::M_MIN | DrawMask::M_CANCEL);
         break;
     case SEL_CANCEL:
         if (onClosed) {
@@ -137,55 +127,48 @@ TimeSelector::OnButtonPressed()
     }
 }
 
+/** Add delta to the value wrapping it in 0..range-1 interval. */
+static u8
+WrapAdd(u8 value, i16 delta, u8 range)
+{
+    i16 result = (value + delta) % range;
+    if (result < 0) {
+        result += range;
+    }
+    return result;
+}
+
 void
-TimeSelector::OnRotEncClick(bool dir)
+TimeSelector::OnRotEnc(i8 delta, i16 accelDelta)
 {
+    /* Selection is moved by one position per batch. */
+    bool dir = delta > 0;
     switch (selection) {
     case SEL_HOUR:
-        if (dir) {
-            value.hour++;
-            if (value.hour > 23) {
-                value.hour = 0;
-            }
-        } else {
-            if (value.hour == 0) {
-                value.hour = 23;
-            } else {
-                value.hour--;
-            }
-        }
-        Draw();
+        value.hour = WrapAdd(value.hour, delta, 24);
+        drawList.Invalidate(DrawMask::M_HOUR);
         break;
     case SEL_MIN:
-        if (dir) {
-            value.min++;
-            if (value.min > 59) {
-                value.min = 0;
-            }
-        } else {
-            if (value.min == 0) {
-                value.min = 59;
-            } else {
-                value.min--;
-            }
-        }
-        Draw();
+        value.min = WrapAdd(value.min, accelDelta, 60);
+        drawList.Invalidate(DrawMask::M_MIN);
         break;
     case SEL_CANCEL:
         if (dir) {
             selection = SEL_OK;
+            drawList.Invalidate(DrawMask::M_CANCEL | DrawMask::M_OK);
         } else {
             selection = SEL_MIN;
+            drawList.Invalidate(DrawMask::M_CANCEL | DrawMask::M_MIN);
         }
-        Draw(true);
         break;
     case SEL_OK:
         if (dir) {
             selection = SEL_HOUR;
+            drawList.Invalidate(DrawMask::M_OK | DrawMask::M_HOUR);
         } else {
             selection = SEL_CANCEL;
+            drawList.Invalidate(DrawMask::M_OK | DrawMask::M_CANCEL);
         }
-        Draw(true);
         break;
     }
 }
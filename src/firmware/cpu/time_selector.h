@@ -31,30 +31,26 @@ public:
     void
     OnButtonPressed() override;
 
-    /** Invoked when rotary encoder rotated on one click.
-     *
-     * @param dir CW direction when true, CCW when false.
-     */
     void
-    OnRotEncClick(bool dir) override;
+    OnRotEnc(i8 delta, i16 accelDelta) override;
+
+    virtual bool
+    RequestClose() override;
 
 private:
     enum {
         CLOCK_COL = 48
     };
 
-    enum DrawState {
-        FULL_DRAW,
-        TITLE = FULL_DRAW,
-        CANCEL,
-        OK,
-        SEP,
-
-        PARTIAL_DRAW,
-        HOUR = PARTIAL_DRAW,
-        MIN,
+    enum DrawMask {
+        M_TITLE =   0x01,
+        M_CANCEL =  0x02,
+        M_OK =      0x04,
+        M_SEP =     0x08,
+        M_HOUR =    0x10,
+        M_MIN =     0x20,
 
-        LAST = MIN
+        M_ALL = M_TITLE | M_CANCEL | M_OK | M_SEP | M_HOUR | M_MIN
     };
 
     enum Selection {
@@ -64,32 +60,33 @@ private:
         SEL_OK
     };
 
+    static const DrawList::Op drawOps[] PROGMEM;
+    DrawList drawList;
+
     const char *title;
     Time value;
     char buf[4];
 
-    u8 drawInProgress:1,
-       drawPending:1,
-       fullDrawPending:1,
-       closeRequested:1,
-       drawState:3,
-       :1,
-
-       selection:2,
+    u8 selection:2,
        :6;
 
-    void
-    Draw(bool full = false);
+    u8
+    DrawTitle();
 
-    /** Issue draw request depending on current draw state. */
-    void
-    IssueDrawRequest();
+    u8
+    DrawCancel();
 
-    void
-    DrawHandler();
+    u8
+    DrawOk();
+
+    u8
+    DrawSeparator();
+
+    u8
+    DrawHour();
 
-    static void
-    _DrawHandler();
+    u8
+    DrawMin();
 
 } __PACKED;
 
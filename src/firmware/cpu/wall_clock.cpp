@@ -0,0 +1,70 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file wall_clock.cpp */
+
+#include "cpu.h"
+
+using namespace adk;
+
+WallClock wallClock;
+
+WallClock::WallClock():
+    time{0, 0, 0}
+{
+    lastTicks = 0;
+    frac = 0;
+}
+
+Rtc::Time
+WallClock::GetTime()
+{
+    AtomicSection as;
+    Advance();
+    return time;
+}
+
+void
+WallClock::Sync(Rtc::Time t)
+{
+    AtomicSection as;
+    Advance();
+    if (t.hour != time.hour || t.min != time.min || t.sec != time.sec) {
+        time = t;
+        /* Phase of the RTC second is unknown, assume the middle to halve the
+         * worst case error.
+         */
+        frac = SECOND_UNITS / 2;
+    }
+}
+
+void
+WallClock::Advance()
+{
+    u32 ticks = clock.GetTicks();
+    frac += (ticks - lastTicks) * TICK_UNITS;
+    lastTicks = ticks;
+    /* Normally advanced by a single second, RTC synchronization prevents long
+     * runs.
+     */
+    while (frac >= SECOND_UNITS) {
+        frac -= SECOND_UNITS;
+        time.sec++;
+        if (time.sec < 60) {
+            continue;
+        }
+        time.sec = 0;
+        time.min++;
+        if (time.min < 60) {
+            continue;
+        }
+        time.min = 0;
+        time.hour++;
+        if (time.hour == 24) {
+            time.hour = 0;
+        }
+    }
+}
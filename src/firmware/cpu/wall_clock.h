@@ -0,0 +1,54 @@
+/* This file is a part of 'hydroponics' project.
+ * Copyright (c) 2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file wall_clock.h
+ * Time of day maintained locally by system clock ticks.
+ */
+
+#ifndef WALL_CLOCK_H_
+#define WALL_CLOCK_H_
+
+/** Wall clock which is advanced by system clock ticks and periodically
+ * synchronized with RTC. Reading time does not involve any bus traffic.
+ */
+class WallClock {
+public:
+    WallClock();
+
+    /** Get current time of day. */
+    Rtc::Time
+    GetTime();
+
+    /** Synchronize with time read from RTC. Fraction of second is preserved if
+     * the local time still matches.
+     */
+    void
+    Sync(Rtc::Time t);
+
+private:
+    /** Fraction of second is counted in units of 256 CPU cycles so that one
+     * system tick is exactly TICK_UNITS.
+     */
+    static constexpr u32 SECOND_UNITS = ADK_MCU_FREQ / 256;
+
+    enum {
+        TICK_UNITS = 1024
+    };
+
+    Rtc::Time time;
+    /** System clock ticks when the time was last advanced. */
+    u32 lastTicks;
+    /** Accumulated fraction of the current second. */
+    u32 frac;
+
+    /** Advance time by system ticks elapsed since last call. */
+    void
+    Advance();
+} __PACKED;
+
+extern WallClock wallClock;
+
+#endif /* WALL_CLOCK_H_ */